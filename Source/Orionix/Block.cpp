@@ -1,25 +1,16 @@
 #include "Block.h"
 #include "Components/StaticMeshComponent.h"
 #include "UObject/ConstructorHelpers.h"
-#include "OrionixCharacter.h"
 
 // Constructor
 ABlock::ABlock()
 {
-	PrimaryActorTick.bCanEverTick = true;								// The tick function can be called in every frame
+	PrimaryActorTick.bCanEverTick = false;								// Blocks are moved by ATunnelManager, they never tick
+	bCanBeInCluster = true;										// FBlockPool clusters its blocks for garbage collection
 
 	meshComponent = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("PlatformMesh"));		// Creates a UStaticMeshComponent and names it
 	RootComponent = meshComponent;									// Sets meshComponent as RootComponent
 
-	triggerBox = CreateDefaultSubobject<UBoxComponent>(TEXT("TriggerBox"));				// Creates a UBoxComponent and names it
-	triggerBox->SetupAttachment(RootComponent);							// Attachs the triggerBox to the RootComponent
-	triggerBox->SetBoxExtent(FVector(250.0f, 10.0f, 250.0f));					// Sets the size of the triggerBox
-	triggerBox->SetRelativeLocation(FVector(250.0f, 0.0f, 250.0f));					// Sets the relative location of the triggerBox
-	triggerBox->SetCollisionEnabled(ECollisionEnabled::QueryOnly);					// Only enable query collisions
-	triggerBox->SetCollisionResponseToAllChannels(ECR_Ignore);					// Close all collision channels
-	triggerBox->SetCollisionResponseToChannel(ECC_Pawn, ECR_Overlap);				// Open collision channel for characters only
-	triggerBox->OnComponentBeginOverlap.AddDynamic(this, &ABlock::onTriggerBoxOverlap);		// Registers the function to be called during collisions with the triggerBox
-
 	hideAndDisableCollision();									// Sets the block as abstract
 }
 
@@ -27,39 +18,26 @@ ABlock::ABlock()
 void ABlock::BeginPlay()
 {
 	Super::BeginPlay();
-}
-
-void ABlock::onTriggerBoxOverlap(UPrimitiveComponent *OverlappedComponent, AActor *OtherActor, UPrimitiveComponent *OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult &SweepResult)
-{
-	if(OtherActor && OtherActor->IsA(AOrionixCharacter::StaticClass()) && flag == false)
-	{
-		onBlockTriggered.Broadcast();								// Broadcasts the onBlockTriggered event to all subscribers.
-		flag = true;
-	}
+	activeCollisionResponses = meshComponent->GetCollisionResponseToChannels();		// Restored when a parked block is used again
 }
 
 // Public Functions
-void ABlock::Tick(float DeltaTime)
+void ABlock::setBlockMesh(UStaticMesh *mesh)
 {
-	Super::Tick(DeltaTime);
-	FVector currentLocation = GetActorLocation();
-	currentLocation = currentLocation + (platformVelocity * DeltaTime);
-	SetActorLocation(currentLocation);
-}
-
-void ABlock::setBlockMesh(const FString &meshPath)
-{
-	UStaticMesh *mesh = LoadObject<UStaticMesh>(nullptr, *meshPath);
 	if(mesh)
 	{
 		meshComponent->SetStaticMesh(mesh);
 	}
 }
 
-void ABlock::rotateBlockRandomly()
+void ABlock::rotateBlockRandomly(const FRandomStream &randomStream)
 {
-	int32 rotationDegree = FMath::RandRange(0, 3) * 90;						// Generates random values between 0-3 and multiplies by 90.
-	setMeshRotation(rotationDegree);
+	setBlockRoll(randomStream.RandRange(0, 3));								// Generates random values between 0-3
+}
+
+void ABlock::setBlockRoll(int32 rollSteps)
+{
+	setMeshRotation(rollSteps * 90);
 }
 
 void ABlock::setBlockLocation(const FVector &newLocation)
@@ -79,6 +57,53 @@ void ABlock::unhideAndEnableCollision()
 	SetActorEnableCollision(true);									// Enables collision
 }
 
+void ABlock::parkAndIgnoreCollision(const FVector &parkingLocation)
+{
+	SetActorHiddenInGame(true);									// Hides actor
+	meshComponent->SetCollisionResponseToAllChannels(ECR_Ignore);					// Only updates the collision filter, the physics body is kept
+	meshComponent->SetAbsolute(true, true, true);							// Stops following the parent while parked
+	meshComponent->SetWorldLocation(parkingLocation, false, nullptr, ETeleportType::TeleportPhysics);
+}
+
+void ABlock::unparkAndRestoreCollision(const FVector &newLocation)
+{
+	meshComponent->SetAbsolute(false, false, false);						// Follows the parent again
+	SetActorRelativeTransform(FTransform(newLocation), false, nullptr, ETeleportType::TeleportPhysics);
+	if(!farDetail)
+	{
+		meshComponent->SetCollisionResponseToChannels(activeCollisionResponses);
+	}
+	if(!GetActorEnableCollision())
+	{
+		SetActorEnableCollision(true);								// Only the first time the block is used
+	}
+	SetActorHiddenInGame(false);									// Shows actor
+}
+
+void ABlock::setMeshVisible(bool bVisible)
+{
+	meshComponent->SetVisibility(bVisible);								// Does nothing if unchanged
+}
+
+void ABlock::setFarDetail(bool bFar, int32 farLodModel)
+{
+	if(bFar == farDetail)
+	{
+		return;										// Collision filter updates are not free
+	}
+
+	farDetail = bFar;
+	meshComponent->SetForcedLodModel(bFar ? farLodModel : 0);
+	if(bFar)
+	{
+		meshComponent->SetCollisionResponseToAllChannels(ECR_Ignore);			// Only updates the collision filter, the physics body is kept
+	}
+	else
+	{
+		meshComponent->SetCollisionResponseToChannels(activeCollisionResponses);
+	}
+}
+
 // Private Functions
 void ABlock::rotateAroundCenter(float rotationValue)
 {
@@ -86,8 +111,7 @@ void ABlock::rotateAroundCenter(float rotationValue)
 	FRotator deltaRotation(rotationValue, 0.0f, 0.0f);						// Create delta rotation vector
 	FRotator newRotation = currentRotation + deltaRotation;						// Calculate new rotation
 
-	FBoxSphereBounds bounds = meshComponent->CalcBounds(FTransform::Identity);			// Calculates the meshComponent's bounding box and sphere
-	FVector newCenter = bounds.Origin + deltaRotation.RotateVector(-bounds.Origin);			// Calculates new center of meshComponent
+	FVector newCenter = meshBounds.Origin + deltaRotation.RotateVector(-meshBounds.Origin);		// Calculates new center of meshComponent from the bounds baked in the block catalog
 
 	meshComponent->SetWorldLocation(newCenter);							// Set meshComponent location
 	meshComponent->SetWorldRotation(newRotation);							// Set meshComponent rotation
@@ -2,11 +2,8 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
-#include "Components/BoxComponent.h"
 #include "Block.generated.h"
 
-DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnBlockTriggered);			// Defines a delegate type that can be dynamically bound to multiple functions, allowing for event broadcasting in Blueprint.
-
 UCLASS()
 class ORIONIX_API ABlock: public AActor
 {
@@ -21,25 +18,26 @@ public:
 	 */
 	ABlock();
 
-	/**
-	 * @brief			Called every frame.
-	 *				Use for update actor's position, check collision etc.
-	 * @param DeltaTime		Time elapsed since the last frame, in seconds.
-	 */
-	virtual void Tick(float DeltaTime) override;
-	
 	/**
 	 * @brief			Sets the static mesh of the meshComponent.
-	 * @param MeshPath		Path of staticMesh to set.
+	 *				The mesh must already be resident; FBlockPool streams it in before handing out the block.
+	 * @param mesh			StaticMesh to set.
 	 */
-	void setBlockMesh(const FString &MeshPath);
+	void setBlockMesh(UStaticMesh *mesh);
 
 	/**
 	 * @brief			Rotates the block to a random orientation around its X-axis.
 	 *				This function seletcs a random rotation from {0, 90, 180, 270} degrees and applies it, and
 	 *				allowing for varied visual appearances of the block in the game world.
+	 * @param randomStream		Stream the rotation is taken from, so seeded runs are reproducible.
 	 */
-	void rotateBlockRandomly();
+	void rotateBlockRandomly(const FRandomStream &randomStream);
+
+	/**
+	 * @brief			Rotates the block around its X-axis by the given number of quarter turns.
+	 * @param rollSteps		Number of 90 degree steps, 0 to 3.
+	 */
+	void setBlockRoll(int32 rollSteps);
 
 	/**	
 	 * @brief			Sets the actor's RootComponent to the specified relative location.
@@ -57,25 +55,42 @@ public:
 	 */
 	void unhideAndEnableCollision();
 
-protected:
 	/**
-	 * @brief			Called when the game starts or when spawned.
-	 *				Use this function to initialize any variables, set up game components, or perform actions that need to occur right as the game begins.
+	 * @brief			Hides the actor and parks it at a fixed world location with every collision channel ignored.
+	 *				Unlike hideAndDisableCollision, the physics body of the block is kept alive. The block stays attached
+	 *				but stops following its parent, so a parked block is not moved with the tunnel every frame.
+	 * @param parkingLocation	World location where the block waits until it is used again.
 	 */
-	virtual void BeginPlay() override;
+	void parkAndIgnoreCollision(const FVector &parkingLocation);
 
+	/**
+	 * @brief			Teleports a parked block into place, makes it visible and restores its collision responses.
+	 *				The block gets the same relative transform attaching it with SnapToTarget and calling setBlockLocation gives.
+	 * @param newLocation		New relative location of the actor's root component.
+	 */
+	void unparkAndRestoreCollision(const FVector &newLocation);
 
-	UFUNCTION()
 	/**
-	 * @brief			Called when another component begins overlapping this block's trigger box.
-	 * @param OverlappedComponent	The component that triggered the overlap event.
-	 * @param OtherActor		The actor that started to overlap with this block.
-	 * @param OtherComp		The component of the other actor thar overlaps with this block.
-	 * @param OtherBodyIndex	The body index of the overlapping component, if applicable.
-	 * @param bFromSweep		Indicates if the overlap was the result of a sweep.
-	 * @param SweepResult		Provides detailed information about the sweep, if bFromSweep is true.
+	 * @brief			Draws or culls the mesh of a block that is part of the tunnel. Collision and the actor's hidden state are untouched.
+	 * @param bVisible		Whether the mesh is drawn.
 	 */
-	void onTriggerBoxOverlap(UPrimitiveComponent *OverlappedComponent, AActor *OtherActor, UPrimitiveComponent *OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult &SweepResult);
+	void setMeshVisible(bool bVisible);
+
+	/**
+	 * @brief			Switches the block between full fidelity and the reduced detail of the far tunnel.
+	 *				A far block ignores every collision channel, keeping its physics body, and draws a forced LOD.
+	 *				unparkAndRestoreCollision keeps the collision of a far block ignored.
+	 * @param bFar			Whether the block is outside the near window of the tunnel.
+	 * @param farLodModel		Forced LOD model of a far block, 1 is LOD0, 0 lets the engine pick.
+	 */
+	void setFarDetail(bool bFar, int32 farLodModel);
+
+protected:
+	/**
+	 * @brief			Called when the game starts or when spawned.
+	 *				Use this function to initialize any variables, set up game components, or perform actions that need to occur right as the game begins.
+	 */
+	virtual void BeginPlay() override;
 
 private:
 	/**
@@ -98,15 +113,12 @@ public:
 	UPROPERTY(VisibleAnywhere)								// It is always visible in the game editor but cannot be changed.
 	UStaticMeshComponent *meshComponent;							// Represents visual appearance of the block in the game world.
 
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Trigger")			// Always visible, cannot be changed, readable but not writeable in Blueprints, listed in the Trigger category.
-	UBoxComponent *triggerBox;								// Represents the end of the block.
-
-	UPROPERTY(BlueprintAssignable)				// Allows the property to be bound to events in Blueprints, enabling custom response to be defined in the Blueprint editor.
-	FOnBlockTriggered onBlockTriggered;			// An event that can be broadcasted to notify other classes or Blueprints when a specific action occurs, allowing for custom event handling.
-
-	bool flag = false;
+	int32 meshIndex = INDEX_NONE;								// Mesh type of the block in FBlockPool
+	int32 instanceIndex = INDEX_NONE;							// Instance drawing this block when the tunnel renders instanced
+	float blockLength = 0.0f;								// Length of the block along the tunnel axis, baked in the block catalog
+	FBoxSphereBounds meshBounds = FBoxSphereBounds(ForceInit);				// Local bounds of the mesh, baked in the block catalog
 
 private:
-	UPROPERTY(VisibleAnywhere, Category = "Platform Velocity")
-	FVector platformVelocity = FVector(500, 0, 0);
+	FCollisionResponseContainer activeCollisionResponses;					// Collision responses of the block while it is part of the tunnel
+	bool farDetail = false;									// Whether the block is drawn and collides as a far block
 };
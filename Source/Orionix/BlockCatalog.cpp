@@ -0,0 +1,158 @@
+#include "BlockCatalog.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StaticMesh.h"
+#include "UObject/ObjectSaveContext.h"
+
+const FPrimaryAssetType UBlockCatalog::PrimaryAssetType = TEXT("BlockCatalog");
+
+// Public Functions
+FPrimaryAssetId UBlockCatalog::GetPrimaryAssetId() const
+{
+	return FPrimaryAssetId(PrimaryAssetType, GetFName());
+}
+
+#if WITH_EDITOR
+void UBlockCatalog::PreSave(FObjectPreSaveContext ObjectSaveContext)
+{
+	bake();
+	Super::PreSave(ObjectSaveContext);
+}
+
+void UBlockCatalog::PostEditChangeProperty(FPropertyChangedEvent &PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	bake();
+}
+#endif
+
+const TArray<FBlockCatalogRecord> &UBlockCatalog::getBlocks() const
+{
+	return blocks;
+}
+
+bool UBlockCatalog::loadBlocks(TArray<FBlockCatalogRecord> &outBlocks)
+{
+	outBlocks.Reset();
+	UAssetManager *assetManager = UAssetManager::GetIfInitialized();
+	if(assetManager)
+	{
+		TArray<FPrimaryAssetId> catalogIds;
+		assetManager->GetPrimaryAssetIdList(PrimaryAssetType, catalogIds);
+		if(catalogIds.Num() > 0)
+		{
+			const UBlockCatalog *catalog = Cast<UBlockCatalog>(assetManager->GetPrimaryAssetPath(catalogIds[0]).TryLoad());
+			if(catalog && catalog->getBlocks().Num() > 0)
+			{
+				outBlocks = catalog->getBlocks();
+				return true;
+			}
+		}
+	}
+
+	getDefaultBlocks(outBlocks);
+	return false;
+}
+
+void UBlockCatalog::getDefaultBlocks(TArray<FBlockCatalogRecord> &outBlocks)
+{
+	struct FDefaultBlock
+	{
+		const TCHAR *meshPath;
+		EBlockSizeClass sizeClass;
+	};
+
+	static const FDefaultBlock defaultBlocks[] =
+	{
+		// Starting Blocks
+		{TEXT("/Game/Blocks/BlockS/BlockS20_SM.BlockS20_SM"), EBlockSizeClass::Starter},
+
+		// Small Blocks
+		{TEXT("/Game/Blocks/BlockS/BlockS1_SM.BlockS1_SM"), EBlockSizeClass::Small},
+		{TEXT("/Game/Blocks/BlockS/BlockS2_SM.BlockS2_SM"), EBlockSizeClass::Small},
+		{TEXT("/Game/Blocks/BlockS/BlockS3_SM.BlockS3_SM"), EBlockSizeClass::Small},
+		{TEXT("/Game/Blocks/BlockS/BlockS4_SM.BlockS4_SM"), EBlockSizeClass::Small},
+		{TEXT("/Game/Blocks/BlockS/BlockS5_SM.BlockS5_SM"), EBlockSizeClass::Small},
+		{TEXT("/Game/Blocks/BlockS/BlockS6_SM.BlockS6_SM"), EBlockSizeClass::Small},
+		{TEXT("/Game/Blocks/BlockS/BlockS7_SM.BlockS7_SM"), EBlockSizeClass::Small},
+		{TEXT("/Game/Blocks/BlockS/BlockS8_SM.BlockS8_SM"), EBlockSizeClass::Small},
+		{TEXT("/Game/Blocks/BlockS/BlockS9_SM.BlockS9_SM"), EBlockSizeClass::Small},
+		{TEXT("/Game/Blocks/BlockS/BlockS10_SM.BlockS10_SM"), EBlockSizeClass::Small},
+		{TEXT("/Game/Blocks/BlockS/BlockS11_SM.BlockS11_SM"), EBlockSizeClass::Small},
+		{TEXT("/Game/Blocks/BlockS/BlockS12_SM.BlockS12_SM"), EBlockSizeClass::Small},
+		{TEXT("/Game/Blocks/BlockS/BlockS13_SM.BlockS13_SM"), EBlockSizeClass::Small},
+		{TEXT("/Game/Blocks/BlockS/BlockS14_SM.BlockS14_SM"), EBlockSizeClass::Small},
+		{TEXT("/Game/Blocks/BlockS/BlockS15_SM.BlockS15_SM"), EBlockSizeClass::Small},
+		{TEXT("/Game/Blocks/BlockS/BlockS16_SM.BlockS16_SM"), EBlockSizeClass::Small},
+		{TEXT("/Game/Blocks/BlockS/BlockS17_SM.BlockS17_SM"), EBlockSizeClass::Small},
+		{TEXT("/Game/Blocks/BlockS/BlockS18_SM.BlockS18_SM"), EBlockSizeClass::Small},
+		{TEXT("/Game/Blocks/BlockS/BlockS19_SM.BlockS19_SM"), EBlockSizeClass::Small},
+		{TEXT("/Game/Blocks/BlockS/BlockS21_SM.BlockS21_SM"), EBlockSizeClass::Small},
+		{TEXT("/Game/Blocks/BlockS/BlockS22_SM.BlockS22_SM"), EBlockSizeClass::Small},
+
+		// Medium Blocks
+		{TEXT("/Game/Blocks/BlockM/BlockM1_SM.BlockM1_SM"), EBlockSizeClass::Medium},
+		{TEXT("/Game/Blocks/BlockM/BlockM2_SM.BlockM2_SM"), EBlockSizeClass::Medium},
+		{TEXT("/Game/Blocks/BlockM/BlockM3_SM.BlockM3_SM"), EBlockSizeClass::Medium},
+		{TEXT("/Game/Blocks/BlockM/BlockM4_SM.BlockM4_SM"), EBlockSizeClass::Medium},
+		{TEXT("/Game/Blocks/BlockM/BlockM5_SM.BlockM5_SM"), EBlockSizeClass::Medium},
+		{TEXT("/Game/Blocks/BlockM/BlockM6_SM.BlockM6_SM"), EBlockSizeClass::Medium},
+		{TEXT("/Game/Blocks/BlockM/BlockM7_SM.BlockM7_SM"), EBlockSizeClass::Medium},
+		{TEXT("/Game/Blocks/BlockM/BlockM8_SM.BlockM8_SM"), EBlockSizeClass::Medium},
+		{TEXT("/Game/Blocks/BlockM/BlockM9_SM.BlockM9_SM"), EBlockSizeClass::Medium},
+		{TEXT("/Game/Blocks/BlockM/BlockM10_SM.BlockM10_SM"), EBlockSizeClass::Medium},
+		{TEXT("/Game/Blocks/BlockM/BlockM11_SM.BlockM11_SM"), EBlockSizeClass::Medium},
+	};
+
+	outBlocks.Reset(UE_ARRAY_COUNT(defaultBlocks));
+	for(const FDefaultBlock &defaultBlock : defaultBlocks)
+	{
+		FBlockCatalogRecord &record = outBlocks.AddDefaulted_GetRef();
+		record.meshPath = FSoftObjectPath(defaultBlock.meshPath);
+		record.sizeClass = defaultBlock.sizeClass;
+		record.weight = getDefaultWeight(defaultBlock.sizeClass);
+		record.length = DefaultBlockLength;					// Bounds stay empty, they are only known to baked catalogs
+	}
+}
+
+float UBlockCatalog::getDefaultWeight(EBlockSizeClass sizeClass)
+{
+	switch(sizeClass)
+	{
+	case EBlockSizeClass::Starter:	return 0.0f;					// The starter block is only used at the start of the tunnel
+	case EBlockSizeClass::Small:	return 3.0f;
+	case EBlockSizeClass::Medium:	return 1.0f;
+	default:			return 1.0f;
+	}
+}
+
+// Private Functions
+#if WITH_EDITOR
+void UBlockCatalog::bake()
+{
+	blocks.Reset(entries.Num());
+	for(const FBlockCatalogEntry &entry : entries)
+	{
+		FBlockCatalogRecord &record = blocks.AddDefaulted_GetRef();
+		record.meshPath = entry.mesh.ToSoftObjectPath();
+		record.sizeClass = entry.sizeClass;
+		record.weight = entry.weight;
+		record.length = entry.length;
+
+		if(const UStaticMesh *mesh = entry.mesh.LoadSynchronous())
+		{
+			FBoxSphereBounds bounds = mesh->GetBounds();
+			record.boundsOrigin = FVector3f(bounds.Origin);
+			record.boundsExtent = FVector3f(bounds.BoxExtent);
+			if(record.length <= 0.0f)
+			{
+				record.length = bounds.BoxExtent.Y * 2.0f;			// The tunnel runs along the block's local Y axis
+			}
+		}
+
+		if(record.length <= 0.0f)
+		{
+			record.length = DefaultBlockLength;
+		}
+	}
+}
+#endif
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "BlockCatalog.generated.h"
+
+/**
+ * @brief			Size class of a block, decides its default selection weight.
+ */
+UENUM(BlueprintType)
+enum class EBlockSizeClass : uint8
+{
+	Starter,									// Only used at the start of the tunnel
+	Small,
+	Medium
+};
+
+/**
+ * @brief			One block of the catalog as it is edited.
+ */
+USTRUCT(BlueprintType)
+struct FBlockCatalogEntry
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Block")
+	TSoftObjectPtr<UStaticMesh> mesh;						// Mesh of the block, streamed in by FBlockPool
+
+	UPROPERTY(EditAnywhere, Category = "Block")
+	EBlockSizeClass sizeClass = EBlockSizeClass::Small;				// Size class of the block
+
+	UPROPERTY(EditAnywhere, Category = "Block", meta = (ClampMin = "0"))
+	float weight = 1.0f;								// Selection weight of the block, 0 is never picked randomly
+
+	UPROPERTY(EditAnywhere, Category = "Block", meta = (ClampMin = "0"))
+	float length = 0.0f;								// Length along the tunnel axis, 0 measures the mesh bounds when baking
+};
+
+/**
+ * @brief			One block of the catalog as it is read at runtime. Baked from FBlockCatalogEntry.
+ */
+USTRUCT()
+struct FBlockCatalogRecord
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, Category = "Block")
+	FSoftObjectPath meshPath;							// Object path of the mesh, ready to be streamed
+
+	UPROPERTY(VisibleAnywhere, Category = "Block")
+	FVector3f boundsOrigin = FVector3f::ZeroVector;					// Local bounds of the mesh
+
+	UPROPERTY(VisibleAnywhere, Category = "Block")
+	FVector3f boundsExtent = FVector3f::ZeroVector;
+
+	UPROPERTY(VisibleAnywhere, Category = "Block")
+	float weight = 0.0f;								// Selection weight of the block
+
+	UPROPERTY(VisibleAnywhere, Category = "Block")
+	float length = 0.0f;								// Length of the block along the tunnel axis
+
+	UPROPERTY(VisibleAnywhere, Category = "Block")
+	EBlockSizeClass sizeClass = EBlockSizeClass::Small;				// Size class of the block
+};
+
+/**
+ * @brief			Lists every block the tunnel is built from. Blocks are edited in **entries** and baked into **blocks**
+ *				when the asset is saved or cooked, so startup reads one small table without resolving meshes or bounds.
+ *				Found by the asset manager as the BlockCatalog primary asset type, see DefaultGame.ini.
+ */
+UCLASS(BlueprintType)
+class ORIONIX_API UBlockCatalog: public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+	/**
+	 * **FUNCTION DECLARATIONS**
+	 */
+public:
+	/**
+	 * @brief			Returns the primary asset id of the catalog, typed BlockCatalog
+	 * @return			Primary asset id
+	 */
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+
+#if WITH_EDITOR
+	/**
+	 * @brief			Bakes the entries before the asset is saved, which includes cooking.
+	 * @param ObjectSaveContext	Context of the save
+	 */
+	virtual void PreSave(FObjectPreSaveContext ObjectSaveContext) override;
+
+	/**
+	 * @brief			Bakes the entries after they are edited so play in editor sees them without saving.
+	 * @param PropertyChangedEvent	The edited property
+	 */
+	virtual void PostEditChangeProperty(FPropertyChangedEvent &PropertyChangedEvent) override;
+#endif
+
+	/**
+	 * @brief			Returns the baked block table
+	 * @return			Every block of the catalog
+	 */
+	const TArray<FBlockCatalogRecord> &getBlocks() const;
+
+	/**
+	 * @brief			Loads the first catalog registered with the asset manager and copies its block table.
+	 *				Falls back to the built-in catalog when no catalog asset exists or it has no blocks.
+	 * @param outBlocks		Filled with the block table
+	 * @return			True if the table comes from a catalog asset
+	 */
+	static bool loadBlocks(TArray<FBlockCatalogRecord> &outBlocks);
+
+	/**
+	 * @brief			Fills the built-in catalog of the /Game/Blocks meshes, every block being **DefaultBlockLength** long.
+	 * @param outBlocks		Filled with the block table
+	 */
+	static void getDefaultBlocks(TArray<FBlockCatalogRecord> &outBlocks);
+
+	/**
+	 * @brief			Returns the selection weight a size class gets in the built-in catalog
+	 * @param sizeClass		Size class of the block
+	 * @return			Selection weight
+	 */
+	static float getDefaultWeight(EBlockSizeClass sizeClass);
+
+private:
+#if WITH_EDITOR
+	/**
+	 * @brief			Rebuilds **blocks** from **entries**, measuring mesh bounds. Editor only, the meshes are loaded.
+	 */
+	void bake();
+#endif
+
+	/**
+	 * **VARIABLE DECLARATIONS**
+	 */
+public:
+	static const FPrimaryAssetType PrimaryAssetType;				// BlockCatalog
+	static constexpr float DefaultBlockLength = 800.0f;				// Length of the built-in blocks along the tunnel axis
+
+private:
+#if WITH_EDITORONLY_DATA
+	UPROPERTY(EditAnywhere, Category = "Catalog")
+	TArray<FBlockCatalogEntry> entries;						// Blocks of the catalog, stripped from cooked builds
+#endif
+
+	UPROPERTY(VisibleAnywhere, Category = "Catalog")
+	TArray<FBlockCatalogRecord> blocks;						// Baked block table
+};
@@ -0,0 +1,40 @@
+#include "BlockPoolCluster.h"
+#include "UObject/UObjectArray.h"
+
+// Public Functions
+bool UBlockPoolCluster::CanBeClusterRoot() const
+{
+	return true;
+}
+
+void UBlockPoolCluster::rebuild(const TArray<ABlock *> &newBlocks)
+{
+	dissolve();
+	blocks.Reset(newBlocks.Num());
+	for(ABlock *block : newBlocks)
+	{
+		if(IsValid(block))
+		{
+			blocks.Add(block);
+		}
+	}
+	CreateCluster();									// Does nothing where the engine does not create clusters
+}
+
+void UBlockPoolCluster::dissolve()
+{
+	if(isClustered())
+	{
+		GUObjectClusters.DissolveCluster(this);
+	}
+}
+
+bool UBlockPoolCluster::isClustered() const
+{
+	return HasAnyInternalFlags(EInternalObjectFlags::ClusterRoot);
+}
+
+int32 UBlockPoolCluster::getBlockCount() const
+{
+	return blocks.Num();
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Block.h"
+#include "BlockPoolCluster.generated.h"
+
+/**
+ * @brief			GC cluster root of the pooled blocks. FBlockPool fills it with every block once the pool is stable,
+ *				so a garbage collection marks the whole pool reachable in one step instead of walking every block,
+ *				its components and their references.
+ *				Clusters are only created where the engine creates them (gc.CreateGCClusters, cooked builds); elsewhere
+ *				the root is a plain object that keeps the blocks referenced.
+ */
+UCLASS()
+class ORIONIX_API UBlockPoolCluster: public UObject
+{
+	GENERATED_BODY()
+
+	/**
+	 * **FUNCTION DECLARATIONS**
+	 */
+public:
+	/**
+	 * @brief			Allows the object to be the root of a GC cluster
+	 * @return			Always true
+	 */
+	virtual bool CanBeClusterRoot() const override;
+
+	/**
+	 * @brief			Dissolves the current cluster and creates a new one holding the given blocks.
+	 *				References a clustered block holds are treated as immutable by the GC, so the blocks must have
+	 *				their meshes assigned before they are clustered.
+	 * @param newBlocks		Every block of the pool.
+	 */
+	void rebuild(const TArray<ABlock *> &newBlocks);
+
+	/**
+	 * @brief			Dissolves the cluster so its blocks are collected one by one again. The blocks stay referenced.
+	 *				Must be called before a clustered block is destroyed.
+	 */
+	void dissolve();
+
+	/**
+	 * @brief			Returns whether the blocks are currently in a GC cluster
+	 * @return			True if the engine created the cluster
+	 */
+	bool isClustered() const;
+
+	/**
+	 * @brief			Returns the number of blocks held by the root
+	 * @return			Number of blocks
+	 */
+	int32 getBlockCount() const;
+
+	/**
+	 * **VARIABLE DECLARATIONS**
+	 */
+private:
+	UPROPERTY()
+	TArray<TObjectPtr<ABlock>> blocks;							// Every block of the pool when the cluster was last built
+};
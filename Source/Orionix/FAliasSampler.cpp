@@ -0,0 +1,101 @@
+#include "FAliasSampler.h"
+
+// Constructor
+FAliasSampler::FAliasSampler()
+{
+}
+
+// Public Functions
+void FAliasSampler::build(const TArray<float> &weights)
+{
+	probabilities.Reset();
+	aliases.Reset();
+
+	double totalWeight = 0.0;
+	for(float weight : weights)
+	{
+		totalWeight += FMath::Max(weight, 0.0f);
+	}
+	if(totalWeight <= 0.0)
+	{
+		return;
+	}
+
+	int32 count = weights.Num();
+	probabilities.SetNumUninitialized(count);
+	aliases.SetNumUninitialized(count);
+
+	TArray<double> scaledWeights;
+	TArray<int32> smallEntries;
+	TArray<int32> largeEntries;
+	scaledWeights.SetNumUninitialized(count);
+	for(int32 i = 0; i < count; i++)
+	{
+		scaledWeights[i] = FMath::Max(weights[i], 0.0f) * count / totalWeight;	// Average column becomes 1
+		if(scaledWeights[i] < 1.0)
+		{
+			smallEntries.Add(i);
+		}
+		else
+		{
+			largeEntries.Add(i);
+		}
+	}
+
+	while(smallEntries.Num() > 0 && largeEntries.Num() > 0)
+	{
+		int32 smallEntry = smallEntries.Pop(false);
+		int32 largeEntry = largeEntries.Pop(false);
+		probabilities[smallEntry] = scaledWeights[smallEntry];
+		aliases[smallEntry] = largeEntry;					// The rest of the column belongs to the large entry
+
+		scaledWeights[largeEntry] = (scaledWeights[largeEntry] + scaledWeights[smallEntry]) - 1.0;
+		if(scaledWeights[largeEntry] < 1.0)
+		{
+			smallEntries.Add(largeEntry);
+		}
+		else
+		{
+			largeEntries.Add(largeEntry);
+		}
+	}
+
+	// Whatever is left is 1 up to rounding errors
+	for(int32 entry : largeEntries)
+	{
+		probabilities[entry] = 1.0f;
+		aliases[entry] = entry;
+	}
+	for(int32 entry : smallEntries)
+	{
+		probabilities[entry] = 1.0f;
+		aliases[entry] = entry;
+	}
+}
+
+int32 FAliasSampler::sample() const
+{
+	if(probabilities.Num() == 0)
+	{
+		return INDEX_NONE;
+	}
+
+	int32 column = FMath::RandRange(0, probabilities.Num() - 1);
+	return FMath::FRand() < probabilities[column] ? column : aliases[column];
+}
+
+int32 FAliasSampler::sample(const FRandomStream &randomStream) const
+{
+	if(probabilities.Num() == 0)
+	{
+		return INDEX_NONE;
+	}
+
+	int32 column = randomStream.RandRange(0, probabilities.Num() - 1);
+	return randomStream.FRand() < probabilities[column] ? column : aliases[column];
+}
+
+int32 FAliasSampler::num() const
+{
+	return probabilities.Num();
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class ORIONIX_API FAliasSampler
+{
+	/**
+	 * **FUNCTION DECLARATIONS**
+	 */
+public:
+	/**
+	 * @brief			Constructor of FAliasSampler class
+	 */
+	FAliasSampler();
+
+	/**
+	 * @brief			Builds the alias table (Vose's method) for the given weights in O(n).
+	 *				An entry with a weight of zero or less is never sampled.
+	 * @param weights		Relative weight of every entry.
+	 */
+	void build(const TArray<float> &weights);
+
+	/**
+	 * @brief			Picks a weighted random entry in O(1).
+	 * @return			Index of the picked entry, or INDEX_NONE if no entry has a positive weight.
+	 */
+	int32 sample() const;
+
+	/**
+	 * @brief			Picks a weighted random entry in O(1) from the given random stream.
+	 *				Safe to call from any thread as long as the stream is only used by that thread.
+	 * @param randomStream		Stream the random numbers are taken from.
+	 * @return			Index of the picked entry, or INDEX_NONE if no entry has a positive weight.
+	 */
+	int32 sample(const FRandomStream &randomStream) const;
+
+	/**
+	 * @brief			Returns the number of entries of the table
+	 * @return			Number of weights given to build
+	 */
+	int32 num() const;
+
+	/**
+	 * **VARIABLE DECLARATIONS**
+	 */
+private:
+	TArray<float> probabilities;				// Probability of keeping the column picked uniformly
+	TArray<int32> aliases;					// Entry returned when the picked column is not kept
+};
@@ -1,133 +1,631 @@
 #include "FBlockPool.h"
+#include "Orionix.h"
+#include "FOrionixTrace.h"
+#include "FOrionixMemory.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StaticMesh.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "UObject/Package.h"
+
+static void benchmarkBlockSelection(int32 pooledEntries, int32 iterations)
+{
+	const int32 meshTypes = 33;
+	const int32 blocksInUse = 10;
+
+	TArray<float> weights;
+	for(int32 type = 0; type < meshTypes; type++)
+	{
+		weights.Add(type == 0 ? 0.0f : (type <= 21 ? 3.0f : 1.0f));			// Same layout as the block catalog
+	}
+
+	TWeightedPool<int32> weightedPool;
+	TArray<int32> uniformPool;
+	weightedPool.initialize(weights);
+	for(int32 entry = 0; entry < pooledEntries; entry++)
+	{
+		weightedPool.add(entry % meshTypes, entry);
+		uniformPool.Add(entry);
+	}
+
+	// Every iteration takes a block and returns the oldest one in use, like a block trigger
+	TArray<int32> inUse;
+	uint64 startCycles = FPlatformTime::Cycles64();
+	for(int32 i = 0; i < iterations; i++)
+	{
+		int32 entry = INDEX_NONE;
+		weightedPool.popWeighted(entry);
+		inUse.Add(entry);
+		if(inUse.Num() > blocksInUse)
+		{
+			weightedPool.add(inUse[0] % meshTypes, inUse[0]);
+			inUse.RemoveAt(0, 1, false);
+		}
+	}
+	double weightedSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - startCycles);
+
+	inUse.Reset();
+	startCycles = FPlatformTime::Cycles64();
+	for(int32 i = 0; i < iterations; i++)
+	{
+		int32 randomIndex = FMath::RandRange(0, uniformPool.Num() - 1);		// Previous getBlockRandomly
+		inUse.Add(uniformPool[randomIndex]);
+		uniformPool.RemoveAt(randomIndex);
+		if(inUse.Num() > blocksInUse)
+		{
+			uniformPool.Push(inUse[0]);
+			inUse.RemoveAt(0, 1, false);
+		}
+	}
+	double uniformSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - startCycles);
+
+	UE_LOG(LogTemp, Warning, TEXT("Pooled entries: %d, weighted free lists: %.1f ns per selection, RemoveAt array: %.1f ns per selection"),
+		pooledEntries, weightedSeconds * 1e9 / iterations, uniformSeconds * 1e9 / iterations);
+}
+
+static FAutoConsoleCommand BenchmarkBlockSelectionCommand(
+	TEXT("orionix.Pool.BenchmarkSelection"),
+	TEXT("Measures the cost of picking and returning a pooled block with 33, 1k and 100k pooled entries."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		for(int32 pooledEntries : {33, 1000, 100000})
+		{
+			benchmarkBlockSelection(pooledEntries, 100000);
+		}
+	}));
+
+DECLARE_CYCLE_STAT(TEXT("Pool Acquire Block"), STAT_OrionixPoolAcquire, STATGROUP_Orionix);
+DECLARE_CYCLE_STAT(TEXT("Pool Return Block"), STAT_OrionixPoolReturn, STATGROUP_Orionix);
+DECLARE_CYCLE_STAT(TEXT("Pool Tick"), STAT_OrionixPoolTick, STATGROUP_Orionix);
+
+static ABlock *tracePopped(ABlock *block)
+{
+	if(block)
+	{
+		FOrionixTrace::traceBlock(EOrionixBlockEvent::Popped, block->GetUniqueID(), INDEX_NONE, block->meshIndex);
+	}
+	return block;
+}
+
+static TAutoConsoleVariable<int32> CVarBlockPoolMemoryBudget(
+	TEXT("orionix.Pool.BlockMemoryBudgetKB"),
+	0,
+	TEXT("Estimated memory the block pool may grow to, in kilobytes. 0 is unlimited. Read when the pool is initialized."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBlockPoolWarmupBudget(
+	TEXT("orionix.Pool.WarmupBudgetMs"),
+	2.0f,
+	TEXT("Time the block pool may spend per frame spawning the rest of the block catalog after the tunnel has started, in milliseconds. Read when the pool is initialized."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBlockPoolMemoryWarning(
+	TEXT("orionix.Pool.MemoryWarningMB"),
+	0.0f,
+	TEXT("Warns once when the block pool and its meshes use more than this many megabytes, 0 disables the warning.\n")
+	TEXT("Measured with the Orionix LLM tags when running with -llm, else estimated from the pooled actors and resident meshes."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<bool> CVarBlockPoolClusterBlocks(
+	TEXT("orionix.Pool.ClusterBlocks"),
+	true,
+	TEXT("Puts every pooled block in one GC cluster once the block catalog is loaded, so garbage collection skips the pool in one step.\n")
+	TEXT("Only effective where the engine creates GC clusters (gc.CreateGCClusters), and only with orionix.Tunnel.KeepPhysicsBodies,\n")
+	TEXT("since detached blocks are attached again on every recycle."),
+	ECVF_Default);
 
 // Constructor
-FBlockPool::FBlockPool(): worldContext(nullptr)
+FBlockPool::FBlockPool()
 {
 }
 
 FBlockPool::~FBlockPool()
 {
-	for(auto *block : availableBlocks)
+	if(meshBatchHandle.IsValid())
 	{
-		if(block)
-		{
-			block->Destroy();
-		}
+		meshBatchHandle->CancelHandle();						// Stops the callbacks into this pool
+		meshBatchHandle.Reset();
 	}
+	if(starterMeshHandle.IsValid())
+	{
+		starterMeshHandle->ReleaseHandle();
+		starterMeshHandle.Reset();
+	}
+
+	dissolveCluster();									// The blocks are destroyed below, they must not be clustered anymore
+	clusterRoot = nullptr;									// Collected with the owner of the pool
+	blockActors.destroyAll();
 }
 // Public Functions
-void FBlockPool::initializePool(UWorld *World, TSubclassOf<ABlock> BlockClass)
+void FBlockPool::initializePool(UWorld *World, TSubclassOf<ABlock> BlockClass, bool bAssignMeshes, int32 synchronousBlockCount)
 {
-	worldContext = World;
-	blockBlueprint = BlockClass;
+	LLM_SCOPE_BYTAG(Orionix_BlockPool);
+	assignMeshes = bAssignMeshes;
+	initializeStartTime = FPlatformTime::Seconds();
 
-	initializeMeshPath();
-	
-	for(const FString &meshPath : meshPaths)
+	if(!UBlockCatalog::loadBlocks(blockTypes))
 	{
-		createBlock(meshPath);
+		UE_LOG(LogTemp, Log, TEXT("No block catalog asset found, using the built-in block catalog"));
 	}
+
+	TArray<float> meshWeights;
+	starterMeshIndex = INDEX_NONE;
+	for(int32 meshIndex = 0; meshIndex < blockTypes.Num(); meshIndex++)
+	{
+		meshWeights.Add(blockTypes[meshIndex].weight);
+		if(starterMeshIndex == INDEX_NONE && blockTypes[meshIndex].sizeClass == EBlockSizeClass::Starter)
+		{
+			starterMeshIndex = meshIndex;
+		}
+	}
+	starterMeshIndex = FMath::Max(starterMeshIndex, 0);						// A catalog without a starter block starts with its first block
+	floorSidesMeasured.Init(0, blockTypes.Num());
+	floorSidesSolid.Init(0, blockTypes.Num());
+
+	FActorPoolSettings settings;								// Grows when the tunnel runs dry instead of leaving it short
+	settings.prewarmCountPerType = 1;							// One block per mesh type
+	settings.synchronousPrewarmCount = synchronousBlockCount;				// Starter block first, the rest of the catalog is spawned by tick
+	settings.prewarmBudgetMs = CVarBlockPoolWarmupBudget.GetValueOnGameThread();
+	settings.memoryBudgetBytes = (int64)CVarBlockPoolMemoryBudget.GetValueOnGameThread() * 1024;
+	settings.spawnOnMiss = false;								// A miss queues time-sliced growth, a block spawned on the spot may not even have its mesh yet
+	blockActors.initialize(World, BlockClass, meshWeights, settings, [this](ABlock *block, int32 meshIndex)
+	{
+		return onBlockSpawned(block, meshIndex);
+	});
+	blockActors.setDestroyingCallback([this](ABlock *block)
+	{
+		dissolveCluster();								// A clustered block cannot be destroyed on its own
+		onBlockDestroying.Broadcast(block);						// Lets the tunnel free what it keeps for the block, e.g. its instance
+	});
+	clusterRoot = NewObject<UBlockPoolCluster>(GetTransientPackage());
+
+	requestMeshes();
+}
+
+void FBlockPool::setRandomStream(const FRandomStream *randomStream)
+{
+	blockActors.setRandomStream(randomStream);
 }
 
 ABlock *FBlockPool::popBlock()
 {
-	if(availableBlocks.Num() > 0)
-	{
-		ABlock *block = availableBlocks.Pop();
-		return block;
-	}
-	return nullptr;
+	SCOPE_CYCLE_COUNTER(STAT_OrionixPoolAcquire);
+	CSV_SCOPED_TIMING_STAT(Orionix, PoolAcquire);
+	return tracePopped(blockActors.acquire());
 }
 
 ABlock *FBlockPool::getBlockRandomly()
 {
-	if(availableBlocks.Num() > 0)
+	SCOPE_CYCLE_COUNTER(STAT_OrionixPoolAcquire);
+	CSV_SCOPED_TIMING_STAT(Orionix, PoolAcquire);
+	return tracePopped(blockActors.acquire());
+}
+
+ABlock *FBlockPool::getStarterBlock()
+{
+	SCOPE_CYCLE_COUNTER(STAT_OrionixPoolAcquire);
+	CSV_SCOPED_TIMING_STAT(Orionix, PoolAcquire);
+	return tracePopped(blockActors.acquireType(starterMeshIndex));
+}
+
+ABlock *FBlockPool::getBlockOfType(int32 meshIndex)
+{
+	SCOPE_CYCLE_COUNTER(STAT_OrionixPoolAcquire);
+	CSV_SCOPED_TIMING_STAT(Orionix, PoolAcquire);
+	if(meshIndex == INDEX_NONE)
 	{
-		int32 randomIndex = FMath::RandRange(0, availableBlocks.Num() - 1);
-		ABlock *block = availableBlocks[randomIndex];
-		availableBlocks.RemoveAt(randomIndex);
-		return block;
+		return tracePopped(blockActors.acquire());
 	}
-	return nullptr;
+	ABlock *block = blockActors.acquireType(meshIndex);					// A miss queues a block of the type, the tunnel waits for it
+	typeMissCount += block ? 0 : 1;
+	return tracePopped(block);
 }
 
 ABlock *FBlockPool::getBlockByIndex(int32 index)
 {
-	if(index < availableBlocks.Num())
+	return blockActors.getActor(index);
+}
+
+int32 FBlockPool::getTotalBlockCount() const
+{
+	return blockActors.getTotalCount();
+}
+
+void FBlockPool::tick()
+{
+	SCOPE_CYCLE_COUNTER(STAT_OrionixPoolTick);
+	CSV_SCOPED_TIMING_STAT(Orionix, PoolTick);
+	LLM_SCOPE_BYTAG(Orionix_BlockPool);
+	blockActors.tick();
+	checkCatalogReady();								// The last warmup block may be spawned after every mesh is resident
+	checkMemoryBudget();
+	updateCluster();
+}
+
+void FBlockPool::addReferencedObjects(FReferenceCollector &Collector)
+{
+	blockActors.addReferencedObjects(Collector);
+	Collector.AddReferencedObject(clusterRoot);
+}
+
+void FBlockPool::rebuildCluster()
+{
+	if(clusterRoot)
 	{
-		return availableBlocks[index];
+		clusterRoot->rebuild(blockActors.getActors());
+		lastBlockCount = blockActors.getTotalCount();
+		clusterDissolved = false;
 	}
-	return nullptr;
+}
+
+void FBlockPool::dissolveCluster()
+{
+	if(clusterRoot)
+	{
+		clusterRoot->dissolve();
+		clusterDissolved = true;
+	}
+}
+
+bool FBlockPool::isClustered() const
+{
+	return clusterRoot && clusterRoot->isClustered();
+}
+
+void FBlockPool::setClusteringAllowed(bool bAllowed)
+{
+	clusteringAllowed = bAllowed;
+	if(!clusteringAllowed)
+	{
+		dissolveCluster();
+	}
+}
+
+void FBlockPool::invalidateCluster()
+{
+	if(isClustered())
+	{
+		dissolveCluster();
+	}
+	lastBlockCountChangeTime = FPlatformTime::Seconds();					// Restarts the one second wait of updateCluster
+}
+
+int32 FBlockPool::spawnBlocks(int32 count)
+{
+	LLM_SCOPE_BYTAG(Orionix_BlockPool);
+	return blockActors.spawnFree(count);
+}
+
+int64 FBlockPool::getMeshMemory() const
+{
+	int64 meshBytes = 0;
+	for(int32 meshIndex = 0; meshIndex < blockTypes.Num(); meshIndex++)
+	{
+		UStaticMesh *mesh = getBlockMesh(meshIndex);
+		meshBytes += mesh ? mesh->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal) : 0;
+	}
+	return meshBytes;
+}
+
+int64 FBlockPool::getMemoryUsage() const
+{
+	if(FOrionixMemory::isTracking())
+	{
+		return FOrionixMemory::getTagBytes(EOrionixMemoryTag::BlockPool) + FOrionixMemory::getTagBytes(EOrionixMemoryTag::BlockMeshes);
+	}
+	return blockActors.getEstimatedMemory() + getMeshMemory();
+}
+
+void FBlockPool::logMemoryUsage() const
+{
+	UE_LOG(LogTemp, Warning, TEXT("Block Pool Memory: %s %.2f KB, Estimated Actors: %.2f KB (%d blocks), Resident Meshes: %.2f KB, Warning At: %.2f KB"),
+		FOrionixMemory::isTracking() ? TEXT("Tracked") : TEXT("Estimated"), getMemoryUsage() / 1024.0, blockActors.getEstimatedMemory() / 1024.0,
+		blockActors.getTotalCount(), getMeshMemory() / 1024.0, CVarBlockPoolMemoryWarning.GetValueOnGameThread() * 1024.0);
+}
+
+const FActorPoolCounters &FBlockPool::getCounters() const
+{
+	return blockActors.getCounters();
+}
+
+int64 FBlockPool::getTypeMissCount() const
+{
+	return typeMissCount;
 }
 
 int32 FBlockPool::getPoolSize()
 {
-	return availableBlocks.Num();
+	return blockActors.getFreeCount();
 }
 
 void FBlockPool::returnBlock(ABlock *block)
 {
+	SCOPE_CYCLE_COUNTER(STAT_OrionixPoolReturn);
+	CSV_SCOPED_TIMING_STAT(Orionix, PoolReturn);
 	if(block)
 	{
-		availableBlocks.Push(block);
+		blockActors.release(block, block->meshIndex);
 	}
 }
 
 void FBlockPool::getPoolStatus() const
 {
-	UE_LOG(LogTemp, Warning, TEXT("Pool Size: %d, Available: %d"), meshPaths.Num(), availableBlocks.Num());
+	UE_LOG(LogTemp, Warning, TEXT("Pool Size: %d, Available: %d, Streaming: %d"), blockActors.getTotalCount(), blockActors.getFreeCount(), pendingBlocks.Num());
+	blockActors.logStatus(TEXT("Block Pool"));
+	UE_LOG(LogTemp, Warning, TEXT("Block Pool: Type Misses: %lld"), typeMissCount);
+	UE_LOG(LogTemp, Warning, TEXT("Time to first playable block: %.2f ms, Time to full pool: %.2f ms"), getTimeToFirstPlayableBlock() * 1000.0, getTimeToFullPool() * 1000.0);
+}
+
+int32 FBlockPool::getMeshCount() const
+{
+	return blockTypes.Num();
+}
+
+float FBlockPool::getBlockLength(int32 meshIndex) const
+{
+	return blockTypes.IsValidIndex(meshIndex) ? blockTypes[meshIndex].length : 0.0f;
+}
+
+bool FBlockPool::hasSolidFloor(int32 meshIndex, const FVector &localDown)
+{
+	if(!floorSidesMeasured.IsValidIndex(meshIndex))
+	{
+		return false;
+	}
+
+	// Blocks only roll in quarter turns around the tunnel axis, so down is one of the four axis directions across the block
+	FVector sideDown = FMath::Abs(localDown.X) > FMath::Abs(localDown.Z) ? FVector(FMath::Sign(localDown.X), 0.0, 0.0) : FVector(0.0, 0.0, FMath::Sign(localDown.Z));
+	if(FMath::Abs(localDown.Y) > 0.01f || FMath::Abs(FVector::DotProduct(localDown, sideDown)) < 0.999f)
+	{
+		return false;									// Tilted, the tunnel is turning
+	}
+	uint8 sideBit = 1 << ((sideDown.X != 0.0 ? 0 : 2) + (sideDown.X + sideDown.Z < 0.0 ? 1 : 0));
+	if(!(floorSidesMeasured[meshIndex] & sideBit))
+	{
+		UStaticMesh *mesh = getBlockMesh(meshIndex);
+		if(!mesh)
+		{
+			return false;								// Measured once the mesh is resident
+		}
+		floorSidesMeasured[meshIndex] |= sideBit;
+		floorSidesSolid[meshIndex] |= measureSolidFloor(mesh, sideDown) ? sideBit : 0;
+	}
+	return (floorSidesSolid[meshIndex] & sideBit) != 0;
+}
+
+void FBlockPool::getBlockWeights(TArray<float> &outWeights) const
+{
+	outWeights.Reset(blockTypes.Num());
+	for(const FBlockCatalogRecord &blockType : blockTypes)
+	{
+		outWeights.Add(blockType.weight);
+	}
+}
+
+UStaticMesh *FBlockPool::getBlockMesh(int32 meshIndex) const
+{
+	if(blockTypes.IsValidIndex(meshIndex))
+	{
+		return Cast<UStaticMesh>(blockTypes[meshIndex].meshPath.ResolveObject());
+	}
+	return nullptr;
+}
+
+bool FBlockPool::isFullyLoaded() const
+{
+	return fullPoolTime >= 0.0;						// Set by checkCatalogReady
+}
+
+double FBlockPool::getTimeToFirstPlayableBlock() const
+{
+	return firstPlayableBlockTime >= 0.0 ? firstPlayableBlockTime - initializeStartTime : -1.0;
+}
+
+double FBlockPool::getTimeToFullPool() const
+{
+	return fullPoolTime >= 0.0 ? fullPoolTime - initializeStartTime : -1.0;
 }
 
 // Private Functions
-void FBlockPool::createBlock(const FString &meshPath)
-{
-	ABlock *NewBlock = worldContext->SpawnActor<ABlock>(blockBlueprint, FVector::ZeroVector, FRotator::ZeroRotator);
-	if(NewBlock)
-	{
-		NewBlock->setBlockMesh(meshPath);
-		availableBlocks.Add(NewBlock);
-	}
-}
-
-void FBlockPool::initializeMeshPath()
-{
-	// Starting Blocks
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockS/BlockS20_SM.BlockS20_SM'"));
-
-	// Small Blocks
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockS/BlockS1_SM.BlockS1_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockS/BlockS2_SM.BlockS2_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockS/BlockS3_SM.BlockS3_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockS/BlockS4_SM.BlockS4_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockS/BlockS5_SM.BlockS5_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockS/BlockS6_SM.BlockS6_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockS/BlockS7_SM.BlockS7_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockS/BlockS8_SM.BlockS8_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockS/BlockS9_SM.BlockS9_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockS/BlockS10_SM.BlockS10_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockS/BlockS11_SM.BlockS11_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockS/BlockS12_SM.BlockS12_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockS/BlockS13_SM.BlockS13_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockS/BlockS14_SM.BlockS14_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockS/BlockS15_SM.BlockS15_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockS/BlockS16_SM.BlockS16_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockS/BlockS17_SM.BlockS17_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockS/BlockS18_SM.BlockS18_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockS/BlockS19_SM.BlockS19_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockS/BlockS21_SM.BlockS21_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockS/BlockS22_SM.BlockS22_SM'"));
-
-	// Medium Blocks
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockM/BlockM1_SM.BlockM1_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockM/BlockM2_SM.BlockM2_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockM/BlockM3_SM.BlockM3_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockM/BlockM4_SM.BlockM4_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockM/BlockM5_SM.BlockM5_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockM/BlockM6_SM.BlockM6_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockM/BlockM7_SM.BlockM7_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockM/BlockM8_SM.BlockM8_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockM/BlockM9_SM.BlockM9_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockM/BlockM10_SM.BlockM10_SM'"));
-	meshPaths.Add(TEXT("StaticMesh'/Game/Blocks/BlockM/BlockM11_SM.BlockM11_SM'"));
+bool FBlockPool::onBlockSpawned(ABlock *block, int32 meshIndex)
+{
+	block->meshIndex = meshIndex;
+	block->blockLength = blockTypes[meshIndex].length;
+	block->meshBounds = FBoxSphereBounds(FVector(blockTypes[meshIndex].boundsOrigin), FVector(blockTypes[meshIndex].boundsExtent), blockTypes[meshIndex].boundsExtent.Size());
+	UStaticMesh *mesh = getBlockMesh(meshIndex);
+	if(mesh)
+	{
+		if(assignMeshes)
+		{
+			block->setBlockMesh(mesh);
+		}
+		return true;									// Blocks grown after warmup find their mesh resident
+	}
+
+	pendingBlocks.Add({block, blockTypes[meshIndex].meshPath});
+	return false;
 }
 
+void FBlockPool::requestMeshes()
+{
+	LLM_SCOPE_BYTAG(Orionix_BlockMeshes);
+	FStreamableManager &streamableManager = UAssetManager::GetStreamableManager();
+
+	// The starter block is the only mesh the tunnel needs to start, so it is the only one waited for
+	starterMeshHandle = streamableManager.RequestAsyncLoad(blockTypes[starterMeshIndex].meshPath, FStreamableDelegate(), FStreamableManager::AsyncLoadHighPriority);
+	if(starterMeshHandle.IsValid())
+	{
+		starterMeshHandle->WaitUntilComplete();
+	}
+	promoteResidentBlocks();
+
+	// The whole catalog is requested, blocks still being warmed up find their mesh resident when they are spawned.
+	// Meshes that are already resident are part of the batch too, so the handle keeps every mesh referenced for instanced blocks.
+	TArray<FSoftObjectPath> batchPaths;
+	bool allResident = true;
+	for(const FBlockCatalogRecord &blockType : blockTypes)
+	{
+		batchPaths.Add(blockType.meshPath);
+		allResident &= blockType.meshPath.ResolveObject() != nullptr;
+	}
+
+	meshBatchHandle = streamableManager.RequestAsyncLoad(batchPaths, FStreamableDelegate::CreateRaw(this, &FBlockPool::onMeshBatchLoaded));
+	if(meshBatchHandle.IsValid() && !allResident)
+	{
+		meshBatchHandle->BindUpdateDelegate(FStreamableUpdateDelegate::CreateRaw(this, &FBlockPool::onMeshBatchUpdated));
+		return;
+	}
+
+	meshesResident = true;									// Nothing left to stream, or nothing could be requested and blocks stay pending for meshes that never load
+	checkCatalogReady();
+}
+
+void FBlockPool::promoteResidentBlocks()
+{
+	for(int32 i = 0; i < pendingBlocks.Num(); i++)
+	{
+		UStaticMesh *mesh = Cast<UStaticMesh>(pendingBlocks[i].meshPath.ResolveObject());
+		if(mesh)
+		{
+			if(assignMeshes)
+			{
+				pendingBlocks[i].block->setBlockMesh(mesh);
+			}
+			blockActors.markReady(pendingBlocks[i].block, pendingBlocks[i].block->meshIndex);
+			pendingBlocks.RemoveAt(i--);					// Keeps catalog order so the starter block stays first
+		}
+	}
+
+	if(blockActors.getFreeCount() > 0 && firstPlayableBlockTime < 0.0)
+	{
+		firstPlayableBlockTime = FPlatformTime::Seconds();
+	}
+
+	checkCatalogReady();
+}
+
+void FBlockPool::checkCatalogReady()
+{
+	if(fullPoolTime >= 0.0 || !meshesResident || pendingBlocks.Num() > 0 || !blockActors.isPrewarmComplete())
+	{
+		return;
+	}
+
+	fullPoolTime = FPlatformTime::Seconds();
+	UE_LOG(LogTemp, Log, TEXT("Block pool loaded: first playable block after %.2f ms, full pool after %.2f ms"), getTimeToFirstPlayableBlock() * 1000.0, getTimeToFullPool() * 1000.0);
+	onCatalogReady.Broadcast();
+}
+
+void FBlockPool::onMeshBatchUpdated(TSharedRef<FStreamableHandle> handle)
+{
+	LLM_SCOPE_BYTAG(Orionix_BlockMeshes);
+	promoteResidentBlocks();
+}
+
+void FBlockPool::onMeshBatchLoaded()
+{
+	LLM_SCOPE_BYTAG(Orionix_BlockMeshes);
+	meshesResident = true;
+	promoteResidentBlocks();
+}
+
+bool FBlockPool::measureSolidFloor(const UStaticMesh *mesh, const FVector &localDown)
+{
+	UBodySetup *bodySetup = mesh->GetBodySetup();
+	if(!bodySetup)
+	{
+		return false;
+	}
+
+	bool bTraceComplex = bodySetup->GetCollisionTraceFlag() == CTF_UseComplexAsSimple;	// The collision the runner's capsule is swept against
+	FBox bounds = mesh->GetBoundingBox();
+	FVector center = bounds.GetCenter();
+	FVector extent = bounds.GetExtent();
+	FVector tunnelAxis = FVector::YAxisVector;						// The tunnel runs along the block's local Y axis
+	FVector acrossAxis = FVector::CrossProduct(tunnelAxis, localDown);
+	float traceLength = extent.Size() * 2.0f;
+	FHitResult hit;
+
+	// The floor ends at the side walls, an open side leaves the whole width to the floor
+	float acrossExtent = FMath::Abs(FVector::DotProduct(extent, acrossAxis));
+	float floorMin = -acrossExtent;
+	float floorMax = acrossExtent;
+	if(bodySetup->LineCheck(hit, FTransform::Identity, center, center - acrossAxis * traceLength, bTraceComplex))
+	{
+		floorMin = -hit.Distance;
+	}
+	if(bodySetup->LineCheck(hit, FTransform::Identity, center, center + acrossAxis * traceLength, bTraceComplex))
+	{
+		floorMax = hit.Distance;
+	}
+	floorMin += FloorSampleSpacing * 0.5f;							// Not into the corners
+	floorMax -= FloorSampleSpacing * 0.5f;
+
+	float lengthExtent = FMath::Abs(FVector::DotProduct(extent, tunnelAxis));
+	int32 lengthSamples = FMath::Max(FMath::CeilToInt32(lengthExtent * 2.0f / FloorSampleSpacing), 1);
+	int32 acrossSamples = FMath::Max(FMath::CeilToInt32((floorMax - floorMin) / FloorSampleSpacing), 0);
+	float floorDistance = -1.0f;
+	for(int32 i = 0; i < lengthSamples; i++)
+	{
+		float along = FMath::Lerp(-lengthExtent, lengthExtent, (i + 0.5f) / lengthSamples);
+		for(int32 j = 0; j <= acrossSamples; j++)
+		{
+			float across = acrossSamples > 0 ? FMath::Lerp(floorMin, floorMax, (float)j / acrossSamples) : 0.0f;
+			FVector start = center + tunnelAxis * along + acrossAxis * across;
+			if(!bodySetup->LineCheck(hit, FTransform::Identity, start, start + localDown * traceLength, bTraceComplex))
+			{
+				return false;							// A hole or a gap
+			}
+			if(FVector::DotProduct(hit.ImpactNormal, -localDown) < 0.999f || (floorDistance >= 0.0f && FMath::Abs(hit.Distance - floorDistance) > 1.0f))
+			{
+				return false;							// A slope, a ledge or an obstacle standing on the floor
+			}
+			floorDistance = hit.Distance;
+		}
+	}
+	return true;
+}
+
+void FBlockPool::checkMemoryBudget()
+{
+	double now = FPlatformTime::Seconds();
+	if(now - lastMemoryCheckTime < 1.0)
+	{
+		return;										// Summing the mesh sizes every frame is not worth it
+	}
+	lastMemoryCheckTime = now;
+
+	int64 warningBytes = (int64)(CVarBlockPoolMemoryWarning.GetValueOnGameThread() * 1024.0f * 1024.0f);
+	bool overBudget = warningBytes > 0 && getMemoryUsage() > warningBytes;
+	if(overBudget && !memoryWarningIssued)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Block pool is over its memory budget: %.2f MB used, %.2f MB allowed"), getMemoryUsage() / (1024.0 * 1024.0), warningBytes / (1024.0 * 1024.0));
+		logMemoryUsage();
+	}
+	memoryWarningIssued = overBudget;						// Warns again after the pool went back under the budget
+}
+
+void FBlockPool::updateCluster()
+{
+	if(!clusterRoot || !isFullyLoaded())
+	{
+		return;										// Blocks still waiting for their mesh would change after being clustered
+	}
+	if(!clusteringAllowed || !CVarBlockPoolClusterBlocks.GetValueOnGameThread())
+	{
+		dissolveCluster();
+		return;
+	}
+
+	double now = FPlatformTime::Seconds();
+	int32 blockCount = blockActors.getTotalCount();
+	if(blockCount != lastBlockCount)
+	{
+		lastBlockCount = blockCount;
+		lastBlockCountChangeTime = now;
+		return;
+	}
+	if((clusterDissolved || blockCount != clusterRoot->getBlockCount()) && now - lastBlockCountChangeTime >= 1.0)
+	{
+		rebuildCluster();								// Not while the pool is growing or shrinking block by block
+	}
+}
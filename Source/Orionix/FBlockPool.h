@@ -2,7 +2,12 @@
 
 #include "CoreMinimal.h"
 #include "Block.h"
-#include <vector>
+#include "BlockCatalog.h"
+#include "BlockPoolCluster.h"
+#include "Engine/StreamableManager.h"
+#include "TActorPool.h"
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnBlockDestroying, ABlock *);			// Broadcast before the pool destroys one of its blocks
 
 class ORIONIX_API FBlockPool
 {
@@ -23,31 +28,87 @@ public:
 	/**
 	 * @brief			Initializes the block pool with specified parameters and pre-populates it with blocks.
 	 *				It ensures the pool is ready with pre-created blocks for use in the game, optimizing runtime performance by avoiding dynamic allocations.
-	 *				All mesh paths are defined in meshPahts to create and add blocks to the pool.
+	 *				Block types are read from the baked UBlockCatalog table, or the built-in catalog if no catalog asset exists.
+	 *				Only the starter block mesh is waited for; every other mesh is requested as one async streaming batch and
+	 *				its block becomes available once the mesh is resident.
+	 *				Only **synchronousBlockCount** blocks are spawned here, the starter block first; the rest of the catalog
+	 *				is spawned by tick within the orionix.Pool.WarmupBudgetMs budget and onCatalogReady is broadcast once it is complete.
 	 * @param World			The game world context where the blocks will be spawned.
 	 * @param BlockClass		The subclass of ABlock to be used for creating new block instances.
+	 * @param bAssignMeshes		Whether streamed meshes are set on the blocks' own meshComponent.
+	 *				False when the tunnel renders blocks as instances and the actors only carry the block logic.
+	 * @param synchronousBlockCount	Number of blocks spawned before returning, INDEX_NONE spawns the whole catalog.
+	 */
+	void initializePool(UWorld *World, TSubclassOf<ABlock> BlockClass, bool bAssignMeshes = true, int32 synchronousBlockCount = INDEX_NONE);
+
+	/**
+	 * @brief			Makes the random block picks of the pool come from the given stream, so a seeded run is reproducible.
+	 * @param randomStream		Stream owned by the caller that outlives the pool, or nullptr for the global random generator.
 	 */
-	void initializePool(UWorld *World, TSubclassOf<ABlock> BlockClass);
+	void setRandomStream(const FRandomStream *randomStream);
 
 	/**
-	 * @brief			Removes and returns the last block from the available blocks pool
-	 * @return			Last block of the block pool
+	 * @brief			Removes and returns a block from the available blocks pool.
+	 *				Never spawns: a miss is counted and queues growth, which tick spawns within its time budget.
+	 * @return			A block of the block pool, or nullptr if none is available
 	 */
 	ABlock *popBlock();
 
 	/**
-	 * @brief			Removes and returns a random block from the available blocks pool
-	 * @return			Random block in the block pool
+	 * @brief			Removes and returns a random block from the available blocks pool in O(1).
+	 *				The mesh type is picked by its selection weight, so small blocks come more often than medium ones
+	 *				and the starter block never comes back.
+	 * @return			Random block in the block pool, or nullptr if none is available
 	 */
 	ABlock *getBlockRandomly();
 
 	/**
-	 * @brief			Returns a block based on the index of the given parameter
+	 * @brief			Removes and returns the starter block (BlockS20) from the available blocks pool
+	 * @return			The starter block, or nullptr if it is not available
+	 */
+	ABlock *getStarterBlock();
+
+	/**
+	 * @brief			Removes and returns a block of the given mesh type from the available blocks pool in O(1).
+	 *				Never substitutes another type, so the tunnel keeps the generated sequence: when no block of the type is
+	 *				free the request is counted as a type miss, a block of the type is queued for growth and nullptr is returned.
+	 * @param meshIndex		Mesh type of the block, INDEX_NONE for a random block.
+	 * @return			A block of the block pool, or nullptr if no block of the type is available
+	 */
+	ABlock *getBlockOfType(int32 meshIndex);
+
+	/**
+	 * @brief			Returns a block based on the index of the given parameter.
+	 *				Indexes every block created by the pool, including blocks whose mesh is still streaming.
 	 * @param index			Index value to be taken from the pool
 	 * @return			Corresponding block in the block pool
 	 */
 	ABlock *getBlockByIndex(int32 index);
 
+	/**
+	 * @brief			Returns the number of blocks created by the pool, whether available, streaming or in use
+	 * @return			Number of blocks owned by the pool
+	 */
+	int32 getTotalBlockCount() const;
+
+	/**
+	 * @brief			Spawns the rest of the catalog, then grows or shrinks the pool within its per-frame budget.
+	 *				Called once per frame by the owner of the pool.
+	 */
+	void tick();
+
+	/**
+	 * @brief			Returns the runtime counters of the pool (misses, peak usage, spawn cost)
+	 * @return			Counters of the underlying actor pool
+	 */
+	const FActorPoolCounters &getCounters() const;
+
+	/**
+	 * @brief			Returns the number of requests for a mesh type that found no free block of the type
+	 * @return			Type misses since the pool was initialized
+	 */
+	int64 getTypeMissCount() const;
+
 	/**
 	 * @brief			Returns available block numbers in the block pool
 	 * @return			Number of blocks available
@@ -65,24 +126,217 @@ public:
 	 */
 	void getPoolStatus() const;
 
+	/**
+	 * @brief			Returns the memory used by the pool and its meshes: the Orionix_BlockPool and Orionix_BlockMeshes
+	 *				LLM tags when LLM is running, else the estimated size of the pooled actors plus the resident meshes.
+	 * @return			Size in bytes
+	 */
+	int64 getMemoryUsage() const;
+
+	/**
+	 * @brief			Returns the estimated size of the resident block meshes
+	 * @return			Size in bytes
+	 */
+	int64 getMeshMemory() const;
+
+	/**
+	 * @brief			Logs the measured and estimated memory of the pool and the warning budget.
+	 */
+	void logMemoryUsage() const;
+
+	/**
+	 * @brief			Reports every block and the cluster root to the garbage collector, so the pool owns its blocks.
+	 *				Called from ATunnelManager::AddReferencedObjects.
+	 * @param Collector		Reference collector of the running garbage collection.
+	 */
+	void addReferencedObjects(FReferenceCollector &Collector);
+
+	/**
+	 * @brief			Puts every block of the pool in one GC cluster, replacing the previous one.
+	 *				tick calls it on its own once the full catalog is available and the pool size has been stable for a second.
+	 */
+	void rebuildCluster();
+
+	/**
+	 * @brief			Dissolves the GC cluster of the blocks. It is rebuilt by tick while orionix.Pool.ClusterBlocks is enabled.
+	 */
+	void dissolveCluster();
+
+	/**
+	 * @brief			Returns whether the blocks are currently in a GC cluster
+	 * @return			True if the engine created the cluster
+	 */
+	bool isClustered() const;
+
+	/**
+	 * @brief			Allows or forbids the GC cluster. A clustered block must keep the object references it had when
+	 *				clustered, visibility, LOD and collision filter changes are fine but attaching is not, so the
+	 *				tunnel only allows the cluster when recycled blocks are parked instead of detached.
+	 * @param bAllowed		Whether tick may build the cluster. Dissolves it if false.
+	 */
+	void setClusteringAllowed(bool bAllowed);
+
+	/**
+	 * @brief			Dissolves the GC cluster after a block changed its object references, e.g. when first attached.
+	 *				tick rebuilds it once the blocks have been left alone for a second.
+	 */
+	void invalidateCluster();
+
+	/**
+	 * @brief			Spawns extra free blocks right away, e.g. to measure garbage collection with a large pool.
+	 *				They are destroyed again once the pool has been idle, like blocks grown on demand.
+	 * @param count			Number of blocks to spawn.
+	 * @return			Number of blocks spawned within the memory budget.
+	 */
+	int32 spawnBlocks(int32 count);
+
+	/**
+	 * @brief			Returns the number of mesh types the pool creates blocks from
+	 * @return			Number of entries in the block catalog
+	 */
+	int32 getMeshCount() const;
+
+	/**
+	 * @brief			Returns the length of a mesh type along the tunnel axis, baked in the block catalog
+	 * @param meshIndex		Index of the mesh type, as stored in ABlock::meshIndex
+	 * @return			Length of the block, 0 for an unknown mesh type
+	 */
+	float getBlockLength(int32 meshIndex) const;
+
+	/**
+	 * @brief			Returns whether the side of a mesh type facing down is a flat floor without holes, gaps or ledges.
+	 *				Measured against the collision of the mesh the first time a side is asked for, see measureSolidFloor.
+	 * @param meshIndex		Index of the mesh type, as stored in ABlock::meshIndex
+	 * @param localDown		World down direction in the space of the block.
+	 * @return			False for a floor with gaps, a mesh still streaming and an unknown mesh type
+	 */
+	bool hasSolidFloor(int32 meshIndex, const FVector &localDown);
+
+	/**
+	 * @brief			Returns the selection weight of every mesh type, indexed by ABlock::meshIndex
+	 * @param outWeights		Filled with the weights
+	 */
+	void getBlockWeights(TArray<float> &outWeights) const;
+
+	/**
+	 * @brief			Returns the static mesh of a mesh type if it is resident
+	 * @param meshIndex		Index of the mesh type, as stored in ABlock::meshIndex
+	 * @return			The static mesh, or nullptr while it is still streaming
+	 */
+	UStaticMesh *getBlockMesh(int32 meshIndex) const;
+
+	/**
+	 * @brief			Returns whether the full block catalog is available
+	 * @return			True once every catalog block has been spawned and every block mesh is resident
+	 */
+	bool isFullyLoaded() const;
+
+	/**
+	 * @brief			Returns the time between initializePool and the first block becoming available
+	 * @return			Elapsed time in seconds, or a negative value if no block is available yet
+	 */
+	double getTimeToFirstPlayableBlock() const;
+
+	/**
+	 * @brief			Returns the time between initializePool and the full block catalog becoming available
+	 * @return			Elapsed time in seconds, or a negative value if the pool is still warming up
+	 */
+	double getTimeToFullPool() const;
+
 private:
 	/**
-	 * @brief			Creates a block to add to the pool and adjust its static mesh.
-	 * @param meshPath		The path of the static mesh to be set
+	 * @brief			Called for every block the actor pool spawns. Sets the mesh type of the block and
+	 *				queues the block until its static mesh is resident.
+	 * @param block			The spawned block
+	 * @param meshIndex		Index of the block type in blockTypes
+	 * @return			Whether the block can be handed out right away
 	 */
-	void createBlock(const FString &meshPath);
+	bool onBlockSpawned(ABlock *block, int32 meshIndex);
 
 	/**
-	 * @brief			Populates the meshPath list with the paths of the static meshes to use
+	 * @brief			Starts the async streaming batch for every mesh of the catalog, which also holds the meshes already resident.
+	 *				The starter block mesh is completed before returning so the tunnel can start immediately.
 	 */
-	void initializeMeshPath();
+	void requestMeshes();
+
+	/**
+	 * @brief			Moves every pending block whose mesh is resident into the available blocks.
+	 */
+	void promoteResidentBlocks();
+
+	/**
+	 * @brief			Warns once when the pool goes over orionix.Pool.MemoryWarningMB. Checked once per second.
+	 */
+	void checkMemoryBudget();
+
+	/**
+	 * @brief			Rebuilds the GC cluster after the pool size changed and stayed the same for a second.
+	 */
+	void updateCluster();
+
+	/**
+	 * @brief			Records the full pool time and broadcasts onCatalogReady the first time the whole catalog is available.
+	 */
+	void checkCatalogReady();
+
+	/**
+	 * @brief			Called by the streaming batch each time one of its meshes has been loaded.
+	 * @param handle		The streaming handle of the batch
+	 */
+	void onMeshBatchUpdated(TSharedRef<FStreamableHandle> handle);
+
+	/**
+	 * @brief			Called once every mesh of the streaming batch has been loaded.
+	 */
+	void onMeshBatchLoaded();
+
+	/**
+	 * @brief			Traces down through the collision of a block mesh from its center line, every **FloorSampleSpacing**
+	 *				along the tunnel axis and across the floor between the side walls. The floor is solid if every trace
+	 *				hits a face looking straight up at the same height.
+	 * @param mesh			Static mesh of the block.
+	 * @param localDown		Down direction in the space of the block, one of its axes across the tunnel.
+	 * @return			True if the floor has no holes, gaps, slopes or ledges
+	 */
+	static bool measureSolidFloor(const UStaticMesh *mesh, const FVector &localDown);
 
 	/**
 	 * **VARIABLE DECLARATIONS**
 	 */
+public:
+	FSimpleMulticastDelegate onCatalogReady;		// Broadcast once when the full block catalog is available
+	FOnBlockDestroying onBlockDestroying;			// Broadcast before a block is destroyed by shrinking or with the pool
+	static constexpr float FloorSampleSpacing = 40.0f;	// Distance between the floor traces of measureSolidFloor, below the runner's capsule radius
+
 private:
-	UWorld *worldContext;					// The game world context where blocks are spawned
-	TSubclassOf<ABlock> blockBlueprint;			// Blueprint class for creating new blocks
-	TArray<FString> meshPaths;				// Paths to meshes used for block appearances
-	TArray<ABlock *> availableBlocks;			// Pool of blocks available for use
+	TArray<FBlockCatalogRecord> blockTypes;			// Baked block catalog, indexed by ABlock::meshIndex
+	TArray<uint8> floorSidesMeasured;			// Block sides measured by hasSolidFloor, one bit per local axis direction, indexed by ABlock::meshIndex
+	TArray<uint8> floorSidesSolid;				// Measured block sides with a solid floor, same layout
+	bool assignMeshes = true;				// Whether blocks get their mesh set on their own meshComponent
+	TActorPool<ABlock> blockActors;				// Every block of the pool, available blocks are kept in one free list per mesh type
+
+	struct FPendingBlock
+	{
+		ABlock *block;					// Block waiting for its mesh
+		FSoftObjectPath meshPath;			// Mesh to be assigned once it is resident
+	};
+	TArray<FPendingBlock> pendingBlocks;			// Blocks whose mesh is still streaming
+
+	TSharedPtr<FStreamableHandle> meshBatchHandle;		// Keeps every block mesh of the catalog referenced while the pool is alive
+	TSharedPtr<FStreamableHandle> starterMeshHandle;	// Keeps the starter block mesh referenced from before the batch is requested
+	bool meshesResident = false;				// Whether every block mesh has been loaded
+	double initializeStartTime = 0.0;			// Time initializePool was called
+	double firstPlayableBlockTime = -1.0;			// Time the first block became available
+	double fullPoolTime = -1.0;				// Time the full block catalog became available
+
+	int32 starterMeshIndex = 0;				// First block type of the Starter size class
+	double lastMemoryCheckTime = 0.0;			// Time checkMemoryBudget last measured the pool
+	bool memoryWarningIssued = false;			// Whether the pool is over its memory budget and has warned about it
+	int64 typeMissCount = 0;				// Requests for a mesh type that found no free block of the type
+
+	UBlockPoolCluster *clusterRoot = nullptr;		// GC cluster root holding every block, referenced through addReferencedObjects
+	int32 lastBlockCount = 0;				// Pool size seen by the last updateCluster
+	double lastBlockCountChangeTime = 0.0;			// Time the pool size last changed
+	bool clusterDissolved = false;				// Whether the cluster was dissolved since it was last built
+	bool clusteringAllowed = true;				// Whether the owner keeps the references of the blocks fixed, see setClusteringAllowed
 };
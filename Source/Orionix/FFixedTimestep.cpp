@@ -0,0 +1,82 @@
+#include "FFixedTimestep.h"
+
+static TAutoConsoleVariable<float> CVarSimStepRate(
+	TEXT("orionix.Sim.StepRate"),
+	60.0f,
+	TEXT("Rate of the fixed tunnel simulation step in steps per second, read when the tunnel starts.\n")
+	TEXT("0 steps the simulation once per frame with the frame time."),
+	ECVF_Default);
+
+// Constructor
+FFixedTimestep::FFixedTimestep(): fixedStepSeconds(0.0), stepSeconds(0.0), maxStepsPerFrame(1), accumulator(0.0), stepCount(0), simulatedSeconds(0.0), droppedSeconds(0.0)
+{
+}
+
+// Public Functions
+double FFixedTimestep::getConfiguredStepSeconds()
+{
+	float stepRate = CVarSimStepRate.GetValueOnGameThread();
+	return stepRate > 0.0f ? 1.0 / stepRate : 0.0;
+}
+
+void FFixedTimestep::initialize(double newStepSeconds, int32 newMaxStepsPerFrame)
+{
+	fixedStepSeconds = FMath::Max(newStepSeconds, 0.0);
+	stepSeconds = fixedStepSeconds;
+	maxStepsPerFrame = FMath::Max(newMaxStepsPerFrame, 1);
+	accumulator = 0.0;
+	stepCount = 0;
+	simulatedSeconds = 0.0;
+	droppedSeconds = 0.0;
+}
+
+int32 FFixedTimestep::advance(double deltaTime)
+{
+	if(fixedStepSeconds <= 0.0)
+	{
+		stepSeconds = deltaTime;							// One variable step per frame
+		return 1;
+	}
+
+	accumulator += deltaTime;
+	int32 steps = FMath::Min((int32)(accumulator / fixedStepSeconds), maxStepsPerFrame);
+	accumulator -= steps * fixedStepSeconds;
+	if(accumulator >= fixedStepSeconds)
+	{
+		droppedSeconds += accumulator - FMath::Fmod(accumulator, fixedStepSeconds);	// The simulation falls behind instead of catching up forever
+		accumulator = FMath::Fmod(accumulator, fixedStepSeconds);
+	}
+
+	return steps;
+}
+
+void FFixedTimestep::finishStep()
+{
+	stepCount++;
+	simulatedSeconds += stepSeconds;
+}
+
+double FFixedTimestep::getStepSeconds() const
+{
+	return stepSeconds;
+}
+
+float FFixedTimestep::getInterpolationAlpha() const
+{
+	return fixedStepSeconds > 0.0 ? (float)(accumulator / fixedStepSeconds) : 1.0f;
+}
+
+int64 FFixedTimestep::getStepCount() const
+{
+	return stepCount;
+}
+
+double FFixedTimestep::getSimulatedSeconds() const
+{
+	return simulatedSeconds;
+}
+
+double FFixedTimestep::getDroppedSeconds() const
+{
+	return droppedSeconds;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * @brief			Turns variable frame times into a whole number of fixed simulation steps.
+ *				The time left over after the last step is kept for the next frame and gives the interpolation alpha
+ *				the renderer uses to blend the previous and the current simulation state.
+ */
+class ORIONIX_API FFixedTimestep
+{
+	/**
+	 * **FUNCTION DECLARATIONS**
+	 */
+public:
+	/**
+	 * @brief			Constructor of FFixedTimestep class
+	 */
+	FFixedTimestep();
+
+	/**
+	 * @brief			Returns the step length set by orionix.Sim.StepRate
+	 * @return			Step length in seconds, 0 when the simulation steps once per frame with the frame time
+	 */
+	static double getConfiguredStepSeconds();
+
+	/**
+	 * @brief			Resets the clock.
+	 * @param newStepSeconds	Length of a step in seconds, 0 or less steps once per frame with the frame time.
+	 * @param newMaxStepsPerFrame	Most steps run in one frame; frame time beyond them is dropped so a slow frame cannot snowball.
+	 */
+	void initialize(double newStepSeconds, int32 newMaxStepsPerFrame);
+
+	/**
+	 * @brief			Adds a frame time to the clock. The steps are counted by finishStep as they are run.
+	 * @param deltaTime		The time elapsed since the last frame.
+	 * @return			Number of steps to run this frame, each getStepSeconds long.
+	 */
+	int32 advance(double deltaTime);
+
+	/**
+	 * @brief			Counts a step returned by advance once it has been run, so getStepCount is the index of the step in progress.
+	 */
+	void finishStep();
+
+	/**
+	 * @brief			Returns the length of the steps returned by the last advance
+	 * @return			Step length in seconds
+	 */
+	double getStepSeconds() const;
+
+	/**
+	 * @brief			Returns how far the clock is between the last step and the next one
+	 * @return			0 right after a step, close to 1 right before the next one; always 1 without a fixed step
+	 */
+	float getInterpolationAlpha() const;
+
+	/**
+	 * @brief			Returns the number of steps finished since initialize, which is the index of the step in progress while one runs
+	 * @return			Step count
+	 */
+	int64 getStepCount() const;
+
+	/**
+	 * @brief			Returns the simulated time since initialize
+	 * @return			Seconds covered by the steps finished
+	 */
+	double getSimulatedSeconds() const;
+
+	/**
+	 * @brief			Returns the frame time dropped because a frame needed more than the maximum number of steps
+	 * @return			Dropped time in seconds
+	 */
+	double getDroppedSeconds() const;
+
+	/**
+	 * **VARIABLE DECLARATIONS**
+	 */
+private:
+	double fixedStepSeconds;				// Length of a step, 0 without a fixed step
+	double stepSeconds;					// Length of the steps returned by the last advance
+	int32 maxStepsPerFrame;					// Most steps run in one frame
+	double accumulator;					// Frame time not simulated yet
+	int64 stepCount;					// Steps finished since initialize
+	double simulatedSeconds;				// Seconds covered by the steps finished
+	double droppedSeconds;					// Frame time dropped by the step limit
+};
@@ -0,0 +1,53 @@
+#include "FOrionixMemory.h"
+
+LLM_DEFINE_TAG(Orionix_BlockPool);
+LLM_DEFINE_TAG(Orionix_TunnelManager);
+LLM_DEFINE_TAG(Orionix_BlockMeshes);
+
+// Public Functions
+bool FOrionixMemory::isTracking()
+{
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+	return FLowLevelMemTracker::IsEnabled();
+#else
+	return false;
+#endif
+}
+
+int64 FOrionixMemory::getTagBytes(EOrionixMemoryTag tag, bool bPeak)
+{
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+	if(isTracking())
+	{
+		UE::LLM::ESizeParams sizeParams = bPeak ? UE::LLM::ESizeParams::ReportPeak : UE::LLM::ESizeParams::ReportCurrent;
+		return FLowLevelMemTracker::Get().GetTagAmountForTracker(ELLMTracker::Default, FName(getTagName(tag)), ELLMTagSet::None, sizeParams);
+	}
+#endif
+	return 0;
+}
+
+const TCHAR *FOrionixMemory::getTagName(EOrionixMemoryTag tag)
+{
+	switch(tag)
+	{
+	case EOrionixMemoryTag::BlockPool:	return TEXT("Orionix_BlockPool");
+	case EOrionixMemoryTag::TunnelManager:	return TEXT("Orionix_TunnelManager");
+	case EOrionixMemoryTag::BlockMeshes:	return TEXT("Orionix_BlockMeshes");
+	default:				return TEXT("");
+	}
+}
+
+void FOrionixMemory::logTags()
+{
+	if(!isTracking())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("LLM is not running, start the game with -llm to track the Orionix tags"));
+		return;
+	}
+
+	for(int32 i = 0; i < (int32)EOrionixMemoryTag::Count; i++)
+	{
+		EOrionixMemoryTag tag = (EOrionixMemoryTag)i;
+		UE_LOG(LogTemp, Warning, TEXT("%s: Current: %.2f KB, Peak: %.2f KB"), getTagName(tag), getTagBytes(tag) / 1024.0, getTagBytes(tag, true) / 1024.0);
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+
+LLM_DECLARE_TAG_API(Orionix_BlockPool, ORIONIX_API);					// Pooled block actors and their components
+LLM_DECLARE_TAG_API(Orionix_TunnelManager, ORIONIX_API);				// Tunnel manager, its model, buffers and instanced components
+LLM_DECLARE_TAG_API(Orionix_BlockMeshes, ORIONIX_API);				// Block mesh requests and the game thread part of their loading
+
+/**
+ * @brief			Orionix Low Level Memory tracker tags.
+ */
+enum class EOrionixMemoryTag : uint8
+{
+	BlockPool,
+	TunnelManager,
+	BlockMeshes,
+	Count
+};
+
+/**
+ * @brief			Reads the Orionix LLM tags. The tags only hold data in builds with LLM compiled in
+ *				when the game runs with -llm; isTracking tells whether they can be trusted.
+ */
+class ORIONIX_API FOrionixMemory
+{
+	/**
+	 * **FUNCTION DECLARATIONS**
+	 */
+public:
+	/**
+	 * @brief			Returns whether the Low Level Memory tracker is running
+	 * @return			True if the tags are being tracked
+	 */
+	static bool isTracking();
+
+	/**
+	 * @brief			Returns the memory tracked under a tag
+	 * @param tag			The tag
+	 * @param bPeak			Whether to return the peak instead of the current amount
+	 * @return			Size in bytes, 0 when the tracker is not running
+	 */
+	static int64 getTagBytes(EOrionixMemoryTag tag, bool bPeak = false);
+
+	/**
+	 * @brief			Returns the LLM name of a tag
+	 * @param tag			The tag
+	 * @return			Name shown by LLM reports and stat LLM
+	 */
+	static const TCHAR *getTagName(EOrionixMemoryTag tag);
+
+	/**
+	 * @brief			Logs the current and peak memory of every Orionix tag.
+	 */
+	static void logTags();
+};
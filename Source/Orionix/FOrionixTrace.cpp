@@ -0,0 +1,58 @@
+#include "FOrionixTrace.h"
+
+UE_TRACE_CHANNEL_DEFINE(OrionixChannel);
+
+UE_TRACE_EVENT_BEGIN(Orionix, Session, NoSync|Important)
+	UE_TRACE_EVENT_FIELD(uint64, CycleFrequency)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Orionix, Frame)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(float, DeltaTime)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Orionix, Block)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(int64, SegmentNumber)
+	UE_TRACE_EVENT_FIELD(uint32, BlockId)
+	UE_TRACE_EVENT_FIELD(int32, MeshIndex)
+	UE_TRACE_EVENT_FIELD(uint8, Kind)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Orionix, Turn)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint8, Kind)
+	UE_TRACE_EVENT_FIELD(uint8, Direction)
+UE_TRACE_EVENT_END()
+
+// Public Functions
+void FOrionixTrace::traceSession()
+{
+	UE_TRACE_LOG(Orionix, Session, OrionixChannel)
+		<< Session.CycleFrequency((uint64)(1.0 / FPlatformTime::GetSecondsPerCycle64()));
+}
+
+void FOrionixTrace::traceFrame(float deltaTime)
+{
+	UE_TRACE_LOG(Orionix, Frame, OrionixChannel)
+		<< Frame.Cycle(FPlatformTime::Cycles64())
+		<< Frame.DeltaTime(deltaTime);
+}
+
+void FOrionixTrace::traceBlock(EOrionixBlockEvent event, uint32 blockId, int64 segmentNumber, int32 meshIndex)
+{
+	UE_TRACE_LOG(Orionix, Block, OrionixChannel)
+		<< Block.Cycle(FPlatformTime::Cycles64())
+		<< Block.SegmentNumber(segmentNumber)
+		<< Block.BlockId(blockId)
+		<< Block.MeshIndex(meshIndex)
+		<< Block.Kind((uint8)event);
+}
+
+void FOrionixTrace::traceTurn(EOrionixTurnEvent event, uint8 turn)
+{
+	UE_TRACE_LOG(Orionix, Turn, OrionixChannel)
+		<< Turn.Cycle(FPlatformTime::Cycles64())
+		<< Turn.Kind((uint8)event)
+		<< Turn.Direction(turn);
+}
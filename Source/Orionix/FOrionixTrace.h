@@ -0,0 +1,68 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Trace/Trace.h"
+
+UE_TRACE_CHANNEL_EXTERN(OrionixChannel, ORIONIX_API);					// Enabled with -trace=default,Orionix
+
+/**
+ * @brief			Steps in the life of a pooled block traced on OrionixChannel.
+ */
+enum class EOrionixBlockEvent : uint8
+{
+	Popped,										// Taken from FBlockPool
+	Attached,									// Attached to the tunnelArrow
+	Shown,										// Visible and collidable at its place in the tunnel
+	Triggered,									// The runner passed the end of its segment
+	Returned									// Given back to FBlockPool
+};
+
+/**
+ * @brief			Steps of a tunnel turn traced on OrionixChannel.
+ */
+enum class EOrionixTurnEvent : uint8
+{
+	Input,										// The player asked for a turn
+	Started,									// The tunnel model started the turn
+	Ended,										// The tunnel reached the target orientation
+	Dropped										// A player turn arrived with the turn queue full and was dropped
+};
+
+/**
+ * @brief			Emits the structured Orionix events of Unreal Insights traces.
+ *				Every event carries the cycle counter it happened at; the Session event gives the cycle frequency,
+ *				so UOrionixTraceAnalyzerCommandlet can turn the events into latencies.
+ */
+class ORIONIX_API FOrionixTrace
+{
+	/**
+	 * **FUNCTION DECLARATIONS**
+	 */
+public:
+	/**
+	 * @brief			Traces the cycle frequency of the session. Called once when the tunnel starts.
+	 */
+	static void traceSession();
+
+	/**
+	 * @brief			Traces the start of a game thread frame of the tunnel.
+	 * @param deltaTime		The time elapsed since the last frame.
+	 */
+	static void traceFrame(float deltaTime);
+
+	/**
+	 * @brief			Traces a step in the life of a block.
+	 * @param event			The step.
+	 * @param blockId		Unique id of the block actor, 0 when the step only knows the segment.
+	 * @param segmentNumber		Segment of the block in the tunnel sequence, INDEX_NONE when the step only knows the block.
+	 * @param meshIndex		Block type.
+	 */
+	static void traceBlock(EOrionixBlockEvent event, uint32 blockId, int64 segmentNumber, int32 meshIndex);
+
+	/**
+	 * @brief			Traces a step of a turn.
+	 * @param event			The step.
+	 * @param turn			Direction of the turn, as ETunnelTurn.
+	 */
+	static void traceTurn(EOrionixTurnEvent event, uint8 turn);
+};
@@ -0,0 +1,358 @@
+#include "FTunnelModel.h"
+#include "Orionix.h"
+#include "FOrionixTrace.h"
+
+DECLARE_CYCLE_STAT(TEXT("Model Step"), STAT_OrionixModelStep, STATGROUP_Orionix);
+DECLARE_CYCLE_STAT(TEXT("Handle Block Trigger"), STAT_OrionixHandleBlockTrigger, STATGROUP_Orionix);
+DECLARE_CYCLE_STAT(TEXT("Update Rotation"), STAT_OrionixUpdateRotation, STATGROUP_Orionix);
+
+/**
+ * @brief			Supplies random segments without blocks, so the model runs on its own.
+ */
+class FBenchmarkTunnelListener: public ITunnelModelListener
+{
+public:
+	FBenchmarkTunnelListener(): randomStream(1234) {}
+
+	virtual bool provideSegment(bool bFirstSegment, FTunnelSegmentDescriptor &outDescriptor, float &outLength) override
+	{
+		outDescriptor.meshIndex = randomStream.RandRange(0, 32);
+		outDescriptor.rollSteps = randomStream.RandRange(0, 3);
+		outDescriptor.turn = !bFirstSegment && randomStream.FRand() < 0.1f ? (ETunnelTurn)randomStream.RandRange(1, 2) : ETunnelTurn::None;
+		outLength = 800.0f;
+		return true;
+	}
+
+	virtual void onSegmentAdded(const FTunnelSegment &segment) override { addedSegments++; }
+	virtual void onSegmentRemoved(const FTunnelSegment &segment) override { removedSegments++; }
+
+	FRandomStream randomStream;
+	int64 addedSegments = 0;
+	int64 removedSegments = 0;
+};
+
+static void benchmarkTunnelModel(int32 maxSegments, int32 steps, float blocksPerStep)
+{
+	FBenchmarkTunnelListener listener;
+	FTunnelModelSettings settings;
+	settings.maxSegments = maxSegments;
+	settings.frameRotation = FQuat(FRotator(0.0f, 90.0f, 0.0f));
+	float stepSeconds = 800.0f * blocksPerStep / settings.platformVelocity.Size();
+
+	FTunnelModel model;
+	model.initialize(settings, &listener);
+	model.fill();
+
+	uint64 startCycles = FPlatformTime::Cycles64();
+	for(int32 i = 0; i < steps; i++)
+	{
+		model.step(stepSeconds, FVector::ZeroVector);
+	}
+	double seconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - startCycles);
+
+	int64 recycles = model.getProgress().getTriggerCount();
+	UE_LOG(LogTemp, Warning, TEXT("Segments: %d, Steps: %d, Recycles: %lld, Total: %.2f ms, %.1f ns per step, %.1f ns per recycle"),
+		maxSegments, steps, recycles, seconds * 1000.0, seconds * 1e9 / steps, recycles > 0 ? seconds * 1e9 / recycles : 0.0);
+}
+
+static FAutoConsoleCommand BenchmarkTunnelModelCommand(
+	TEXT("orionix.Tunnel.BenchmarkModel"),
+	TEXT("Runs the tunnel model without actors through a million steps and logs the cost per step and per block recycle."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		benchmarkTunnelModel(10, 1000000, 0.25f);
+		benchmarkTunnelModel(10, 1000000, 1.0f);
+		benchmarkTunnelModel(100, 1000000, 1.0f);
+	}));
+
+// Constructor
+FTunnelModel::FTunnelModel(): listener(nullptr), tunnelAxis(FVector(0, 1, 0)), nextSegmentLocation(FVector::ZeroVector), triggerBoxShift(FVector::ZeroVector), targetSegments(0),
+	frameLocation(FVector::ZeroVector), frameRotation(FQuat::Identity), previousFrameLocation(FVector::ZeroVector), previousFrameRotation(FQuat::Identity),
+	bTurning(false), turnElapsed(0.0f), turnStart(FQuat::Identity), turnTarget(FQuat::Identity), turningSeconds(0.0), pendingTurnInputTime(-1.0), startedTurnInputTime(-1.0), droppedTurnCount(0),
+	recycleCount(0), totalRecycleTime(0.0), maxRecycleTime(0.0)
+{
+}
+
+// Public Functions
+void FTunnelModel::initialize(const FTunnelModelSettings &newSettings, ITunnelModelListener *newListener)
+{
+	settings = newSettings;
+	listener = newListener;
+	segments.initialize(settings.maxSegments + 1);						// A trigger appends the new segment before it removes the oldest one
+	tunnelAxis = settings.tunnelAxis.GetSafeNormal();
+	nextSegmentLocation = settings.startPosition;
+	triggerBoxShift = FVector::ZeroVector;
+	targetSegments = settings.maxSegments;
+	progressTracker.reset(FVector::DotProduct(settings.startPosition, tunnelAxis));	// The first block ends where it starts, like its old trigger box
+
+	frameLocation = previousFrameLocation = settings.frameLocation;
+	frameRotation = previousFrameRotation = settings.frameRotation;
+	bTurning = false;
+	turnElapsed = 0.0f;
+	turningSeconds = 0.0;
+	turnQueue.Reset(FMath::Max(settings.turnQueueCapacity, 0));
+	pendingTurnInputTime = -1.0;
+	startedTurnInputTime = -1.0;
+	droppedTurnCount = 0;
+
+	recycleCount = 0;
+	totalRecycleTime = 0.0;
+	maxRecycleTime = 0.0;
+}
+
+int32 FTunnelModel::fill()
+{
+	int32 appended = 0;
+	while(appendSegment(targetSegments))
+	{
+		appended++;
+	}
+	return appended;
+}
+
+void FTunnelModel::setTargetSegments(int32 newTargetSegments)
+{
+	targetSegments = FMath::Clamp(newTargetSegments, 1, settings.maxSegments);
+}
+
+int32 FTunnelModel::getTargetSegments() const
+{
+	return targetSegments;
+}
+
+int32 FTunnelModel::step(float stepSeconds, const TOptional<FVector> &runnerLocation)
+{
+	SCOPE_CYCLE_COUNTER(STAT_OrionixModelStep);
+	previousFrameLocation = frameLocation;
+	previousFrameRotation = frameRotation;
+	frameLocation += settings.platformVelocity * stepSeconds;			// Every segment is relative to the frame, so moving it moves the whole tunnel
+
+	int32 triggers = 0;
+	if(runnerLocation.IsSet())
+	{
+		FVector localRunnerLocation = getFrame().InverseTransformPosition(runnerLocation.GetValue());
+		progressTracker.update(FVector::DotProduct(localRunnerLocation, tunnelAxis));
+		while(progressTracker.isTriggerPending() && segments.num() > 0)
+		{
+			float passedLength = segments.first().length;				// The next trigger is one segment length further
+			handleBlockTrigger();
+			progressTracker.advance(passedLength);
+			triggers++;
+		}
+	}
+
+	updateRotation(stepSeconds);
+	return triggers;
+}
+
+void FTunnelModel::turn(ETunnelTurn turn, double inputTime)
+{
+	if(turn == ETunnelTurn::None)
+	{
+		return;
+	}
+
+	FTunnelTurnCommand command;
+	command.turn = turn;
+	command.inputTime = inputTime;
+	if(!bTurning)
+	{
+		startTurn(command);
+	}
+	else if(turnQueue.Num() < settings.turnQueueCapacity)
+	{
+		turnQueue.Add(command);
+	}
+	else
+	{
+		droppedTurnCount++;
+		if(inputTime >= 0.0)
+		{
+			FOrionixTrace::traceTurn(EOrionixTurnEvent::Dropped, (uint8)turn);		// Closes the Input traced for it
+		}
+	}
+}
+
+bool FTunnelModel::takeStartedTurnInput(double &outInputTime)
+{
+	if(startedTurnInputTime < 0.0)
+	{
+		return false;
+	}
+	outInputTime = startedTurnInputTime;
+	startedTurnInputTime = -1.0;
+	return true;
+}
+
+int32 FTunnelModel::getQueuedTurnCount() const
+{
+	return turnQueue.Num();
+}
+
+int64 FTunnelModel::getDroppedTurnCount() const
+{
+	return droppedTurnCount;
+}
+
+FTransform FTunnelModel::getInterpolatedFrame(float interpolationAlpha) const
+{
+	return FTransform(FQuat::Slerp(previousFrameRotation, frameRotation, interpolationAlpha), FMath::Lerp(previousFrameLocation, frameLocation, interpolationAlpha));
+}
+
+FTransform FTunnelModel::getFrame() const
+{
+	return FTransform(frameRotation, frameLocation);
+}
+
+const FTunnelSegmentBuffer &FTunnelModel::getSegments() const
+{
+	return segments;
+}
+
+const FTunnelProgressTracker &FTunnelModel::getProgress() const
+{
+	return progressTracker;
+}
+
+FVector FTunnelModel::getTriggerBoxShift() const
+{
+	return triggerBoxShift;
+}
+
+const FVector &FTunnelModel::getTunnelAxis() const
+{
+	return tunnelAxis;
+}
+
+bool FTunnelModel::isTurning() const
+{
+	return bTurning;
+}
+
+double FTunnelModel::getTurningSeconds() const
+{
+	return turningSeconds;
+}
+
+int64 FTunnelModel::getRecycleStats(double &outAverageSeconds, double &outMaxSeconds) const
+{
+	outAverageSeconds = recycleCount > 0 ? totalRecycleTime / recycleCount : 0.0;
+	outMaxSeconds = maxRecycleTime;
+	return recycleCount;
+}
+
+// Private Functions
+void FTunnelModel::startTurn(const FTunnelTurnCommand &command)
+{
+	bTurning = true;
+	turnElapsed = 0.0f;
+	turnStart = frameRotation;
+	float turnAngle = command.turn == ETunnelTurn::Right ? 90.0f : -90.0f;
+	turnTarget = turnStart * FQuat(FRotator(turnAngle, 0.0f, 0.0f));			// Local rotation around the tunnel axis
+	if(command.inputTime >= 0.0)
+	{
+		pendingTurnInputTime = command.inputTime;					// Published by the first step that rotates the frame
+	}
+	FOrionixTrace::traceTurn(EOrionixTurnEvent::Started, (uint8)command.turn);
+}
+
+bool FTunnelModel::appendSegment(int32 segmentLimit)
+{
+	if(segments.num() >= segmentLimit || !listener)
+	{
+		return false;
+	}
+
+	FTunnelSegment segment;
+	FTunnelSegmentDescriptor descriptor;
+	if(!listener->provideSegment(segments.num() == 0, descriptor, segment.length))
+	{
+		return false;
+	}
+
+	segment.meshIndex = descriptor.meshIndex;
+	segment.rollSteps = descriptor.rollSteps;
+	segment.turn = descriptor.turn;
+	segment.location = nextSegmentLocation;
+	const FTunnelSegment *storedSegment = segments.push(segment);
+	check(storedSegment);
+	nextSegmentLocation += tunnelAxis * segment.length;
+	listener->onSegmentAdded(*storedSegment);
+	return true;
+}
+
+void FTunnelModel::handleBlockTrigger()
+{
+	SCOPE_CYCLE_COUNTER(STAT_OrionixHandleBlockTrigger);
+	CSV_SCOPED_TIMING_STAT(Orionix, HandleBlockTrigger);
+	double startTime = FPlatformTime::Seconds();
+	if(segments.num() > 0)
+	{
+		FOrionixTrace::traceBlock(EOrionixBlockEvent::Triggered, 0, segments.first().segmentNumber, segments.first().meshIndex);
+	}
+	appendSegment(targetSegments + 1);							// The new segment is appended before the oldest one is removed, none while shrinking
+
+	if(segments.num() > 0)
+	{
+		if(listener)
+		{
+			listener->onSegmentRemoved(segments.first());
+		}
+		segments.pop();
+	}
+
+	triggerBoxShift += settings.triggerBoxOffset;
+	if(segments.num() > 0)
+	{
+		turn(segments.first().turn);							// The runner has reached the next segment
+	}
+
+	double recycleTime = FPlatformTime::Seconds() - startTime;
+	recycleCount++;
+	totalRecycleTime += recycleTime;
+	maxRecycleTime = FMath::Max(maxRecycleTime, recycleTime);
+	if(listener)
+	{
+		listener->onBlockTriggerHandled(recycleTime);
+	}
+}
+
+void FTunnelModel::updateRotation(float stepSeconds)
+{
+	if(!bTurning)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_OrionixUpdateRotation);
+	CSV_SCOPED_TIMING_STAT(Orionix, UpdateRotation);
+	turnElapsed += stepSeconds;
+	turningSeconds += stepSeconds;
+	if(stepSeconds > 0.0f && pendingTurnInputTime >= 0.0)
+	{
+		startedTurnInputTime = pendingTurnInputTime;					// This step rotates the frame
+		pendingTurnInputTime = -1.0;
+	}
+	float turnAlpha = settings.turnDuration > 0.0f ? FMath::Clamp(turnElapsed / settings.turnDuration, 0.0f, 1.0f) : 1.0f;
+	if(turnAlpha >= 1.0f)
+	{
+		float remainingSeconds = settings.turnDuration > 0.0f ? FMath::Min(turnElapsed - settings.turnDuration, stepSeconds) : 0.0f;
+		turningSeconds -= remainingSeconds;
+		frameRotation = turnTarget;							// Ends exactly on the target orientation
+		bTurning = false;
+		turnElapsed = 0.0f;
+		FOrionixTrace::traceTurn(EOrionixTurnEvent::Ended, 0);
+
+		if(turnQueue.Num() > 0)
+		{
+			FTunnelTurnCommand command = turnQueue[0];
+			turnQueue.RemoveAt(0, 1, false);
+			startTurn(command);
+			updateRotation(remainingSeconds);					// No step without rotation between chained turns
+		}
+		return;
+	}
+
+	float easedAlpha = settings.turnEasing ? settings.turnEasing(turnAlpha) : turnAlpha;
+	frameRotation = FQuat::Slerp(turnStart, turnTarget, easedAlpha);
+}
@@ -0,0 +1,267 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FTunnelProgressTracker.h"
+#include "FTunnelSegmentBuffer.h"
+#include "FTunnelSequenceGenerator.h"
+
+/**
+ * @brief			Layout and motion of an FTunnelModel.
+ */
+struct FTunnelModelSettings
+{
+	int32 maxSegments = 10;							// Maximum number of segments in the tunnel at the same time
+	FVector startPosition = FVector(-250, 0, -250);			// Location of the first segment relative to the tunnel frame
+	FVector tunnelAxis = FVector(0, 1, 0);				// Direction the segments follow each other in, relative to the tunnel frame
+	FVector platformVelocity = FVector(500, 0, 0);			// World space velocity the tunnel frame scrolls with
+	FVector triggerBoxOffset = FVector(-800, 0, 0);			// Distance the turn trigger boxes move forward per block trigger
+	FVector frameLocation = FVector::ZeroVector;			// Initial world location of the tunnel frame
+	FQuat frameRotation = FQuat::Identity;				// Initial world rotation of the tunnel frame
+	float turnDuration = 0.75f;					// Seconds a quarter turn takes
+	TFunction<float(float)> turnEasing;				// Eases the linear progress of a turn, linear when unset
+	int32 turnQueueCapacity = 2;					// Turns that can wait for the current one to end, later ones are dropped
+};
+
+/**
+ * @brief			Turn waiting in the turn queue of an FTunnelModel.
+ */
+struct FTunnelTurnCommand
+{
+	ETunnelTurn turn = ETunnelTurn::None;				// Direction of the turn
+	double inputTime = -1.0;					// FPlatformTime::Seconds() of the player input, negative for turns not made by the player
+};
+
+/**
+ * @brief			Receives the segment changes of an FTunnelModel and supplies the segments it appends.
+ *				ATunnelManager implements it with pooled blocks; benchmarks can implement it with nothing at all.
+ */
+class ITunnelModelListener
+{
+public:
+	virtual ~ITunnelModelListener() {}
+
+	/**
+	 * @brief			Supplies the next segment of the tunnel.
+	 * @param bFirstSegment		Whether the tunnel is empty, the first segment is the starter block.
+	 * @param outDescriptor		Filled with the block type, roll and turn of the segment.
+	 * @param outLength		Filled with the length of the segment along the tunnel axis.
+	 * @return			False if no segment is available yet; the tunnel stays shorter until the next fill.
+	 */
+	virtual bool provideSegment(bool bFirstSegment, FTunnelSegmentDescriptor &outDescriptor, float &outLength) = 0;
+
+	/**
+	 * @brief			Called after a segment was appended to the tunnel.
+	 * @param segment		The new segment.
+	 */
+	virtual void onSegmentAdded(const FTunnelSegment &segment) = 0;
+
+	/**
+	 * @brief			Called before the oldest segment is removed from the tunnel.
+	 * @param segment		The removed segment.
+	 */
+	virtual void onSegmentRemoved(const FTunnelSegment &segment) = 0;
+
+	/**
+	 * @brief			Called after a block trigger has been handled.
+	 * @param seconds		Time the trigger took, listener work included.
+	 */
+	virtual void onBlockTriggerHandled(double seconds) {}
+};
+
+/**
+ * @brief			Simulation state of the tunnel without any actor or component: the segment sequence and its layout,
+ *				the scrolling and turning tunnel frame, block triggers and the trigger box progression.
+ *				ATunnelManager is a view that syncs the tunnelArrow, blocks and trigger boxes from it, so the same logic
+ *				runs in a benchmark or a test without a world.
+ */
+class ORIONIX_API FTunnelModel
+{
+	/**
+	 * **FUNCTION DECLARATIONS**
+	 */
+public:
+	/**
+	 * @brief			Constructor of FTunnelModel class
+	 */
+	FTunnelModel();
+
+	/**
+	 * @brief			Resets the model to an empty tunnel. Allocates the segment buffer once.
+	 * @param newSettings		Layout and motion of the tunnel.
+	 * @param newListener		Supplies the segments and receives the changes, must outlive the model.
+	 */
+	void initialize(const FTunnelModelSettings &newSettings, ITunnelModelListener *newListener);
+
+	/**
+	 * @brief			Appends segments from the listener until the tunnel holds its target number of segments or the listener has none available.
+	 * @return			Number of segments appended.
+	 */
+	int32 fill();
+
+	/**
+	 * @brief			Sets how many segments the tunnel should hold. A longer tunnel is filled by fill, a shorter one shrinks
+	 *				by one segment per block trigger, so no segment ahead of the runner ever disappears.
+	 * @param newTargetSegments	Number of segments, clamped to 1..maxSegments.
+	 */
+	void setTargetSegments(int32 newTargetSegments);
+
+	/**
+	 * @brief			Returns how many segments the tunnel should hold
+	 * @return			Target number of segments, maxSegments until setTargetSegments is called
+	 */
+	int32 getTargetSegments() const;
+
+	/**
+	 * @brief			Runs one simulation step: scrolls the tunnel frame, handles a block trigger for every block end the runner
+	 *				passed and advances the current turn.
+	 * @param stepSeconds		The length of the simulation step.
+	 * @param runnerLocation	World location of the runner, unset when there is no runner.
+	 * @return			Number of block triggers handled.
+	 */
+	int32 step(float stepSeconds, const TOptional<FVector> &runnerLocation);
+
+	/**
+	 * @brief			Starts a quarter turn, or queues it while a turn is in progress. A queued turn starts in the step the
+	 *				current one ends, with the rest of that step. Turns arriving with a full queue are dropped.
+	 * @param turn			Direction of the turn, ETunnelTurn::None does nothing.
+	 * @param inputTime		FPlatformTime::Seconds() of the player input, negative for turns not made by the player.
+	 */
+	void turn(ETunnelTurn turn, double inputTime = -1.0);
+
+	/**
+	 * @brief			Returns the input time of the player turn whose first rotating step ran since the last call, once per turn.
+	 *				A turn accepted between steps is only returned after a step has rotated the frame, so the view, which calls
+	 *				it after applying the frame state, measures the input to first rotated frame latency.
+	 * @param outInputTime		Filled with FPlatformTime::Seconds() of the input.
+	 * @return			False if no player turn started since the last call.
+	 */
+	bool takeStartedTurnInput(double &outInputTime);
+
+	/**
+	 * @brief			Returns the number of turns waiting for the current one to end
+	 * @return			Number of queued turns
+	 */
+	int32 getQueuedTurnCount() const;
+
+	/**
+	 * @brief			Returns the number of turns dropped because the queue was full
+	 * @return			Dropped turns since initialize
+	 */
+	int64 getDroppedTurnCount() const;
+
+	/**
+	 * @brief			Returns the tunnel frame between the previous and the current step.
+	 * @param interpolationAlpha	0 for the previous step, 1 for the current one.
+	 * @return			Interpolated world transform of the tunnel frame
+	 */
+	FTransform getInterpolatedFrame(float interpolationAlpha) const;
+
+	/**
+	 * @brief			Returns the tunnel frame after the last step
+	 * @return			World transform of the tunnel frame
+	 */
+	FTransform getFrame() const;
+
+	/**
+	 * @brief			Returns the segments in the tunnel
+	 * @return			Segments, oldest first
+	 */
+	const FTunnelSegmentBuffer &getSegments() const;
+
+	/**
+	 * @brief			Returns the progress tracker firing the block triggers
+	 * @return			Progress tracker
+	 */
+	const FTunnelProgressTracker &getProgress() const;
+
+	/**
+	 * @brief			Returns how far the turn trigger boxes moved forward since initialize
+	 * @return			Offset relative to the tunnel frame
+	 */
+	FVector getTriggerBoxShift() const;
+
+	/**
+	 * @brief			Returns the direction the segments follow each other in
+	 * @return			Normalized axis relative to the tunnel frame
+	 */
+	const FVector &getTunnelAxis() const;
+
+	/**
+	 * @brief			Returns whether a turn is in progress
+	 * @return			True while the tunnel frame is turning
+	 */
+	bool isTurning() const;
+
+	/**
+	 * @brief			Returns the simulated time spent turning since initialize
+	 * @return			Seconds with a turn in progress
+	 */
+	double getTurningSeconds() const;
+
+	/**
+	 * @brief			Returns the number of block triggers handled and their average and worst cost, listener work included.
+	 * @param outAverageSeconds	Filled with the average cost in seconds.
+	 * @param outMaxSeconds		Filled with the worst cost in seconds.
+	 * @return			Number of block triggers handled since initialize.
+	 */
+	int64 getRecycleStats(double &outAverageSeconds, double &outMaxSeconds) const;
+
+private:
+	/**
+	 * @brief			Appends one segment from the listener after the newest one.
+	 * @param segmentLimit		Number of segments the tunnel may hold after the append.
+	 * @return			False if the tunnel is full or the listener has no segment available.
+	 */
+	bool appendSegment(int32 segmentLimit);
+
+	/**
+	 * @brief			Appends a segment, removes the oldest one, moves the trigger boxes forward and takes the turn of the
+	 *				segment the runner has reached.
+	 */
+	void handleBlockTrigger();
+
+	/**
+	 * @brief			Starts a quarter turn from the current orientation.
+	 * @param command		The turn and its input time.
+	 */
+	void startTurn(const FTunnelTurnCommand &command);
+
+	/**
+	 * @brief			Advances the current turn and ends it exactly on its target orientation.
+	 *				The next queued turn starts right away and gets the time left in the step.
+	 * @param stepSeconds		The length of the simulation step.
+	 */
+	void updateRotation(float stepSeconds);
+
+	/**
+	 * **VARIABLE DECLARATIONS**
+	 */
+private:
+	FTunnelModelSettings settings;					// Layout and motion of the tunnel
+	ITunnelModelListener *listener;					// Supplies the segments and receives the changes
+	FTunnelSegmentBuffer segments;					// Segments in the tunnel, oldest first
+	FTunnelProgressTracker progressTracker;				// Fires block triggers from the runner's distance along the tunnel
+	FVector tunnelAxis;						// Normalized settings.tunnelAxis
+	FVector nextSegmentLocation;					// Location of the next appended segment relative to the tunnel frame
+	FVector triggerBoxShift;					// Distance the trigger boxes moved forward since initialize
+	int32 targetSegments;						// Number of segments the tunnel should hold, at most settings.maxSegments
+
+	FVector frameLocation;						// World location of the tunnel frame after the last step
+	FQuat frameRotation;						// World rotation of the tunnel frame after the last step
+	FVector previousFrameLocation;					// World location of the tunnel frame before the last step
+	FQuat previousFrameRotation;					// World rotation of the tunnel frame before the last step
+
+	bool bTurning;							// Whether a turn is in progress
+	float turnElapsed;						// Seconds since the current turn started
+	FQuat turnStart;						// Rotation of the tunnel frame when the turn started
+	FQuat turnTarget;						// Rotation of the tunnel frame when the turn ends
+	double turningSeconds;						// Simulated time spent turning since initialize
+	TArray<FTunnelTurnCommand> turnQueue;				// Turns waiting for the current one to end, oldest first, never reallocated
+	double pendingTurnInputTime;					// Input time of the player turn started but not rotated by a step yet, negative if none
+	double startedTurnInputTime;					// Input time of the last player turn that rotated the frame, negative once taken by the view
+	int64 droppedTurnCount;						// Turns dropped because the queue was full
+
+	int64 recycleCount;						// Number of block triggers handled
+	double totalRecycleTime;					// Total time spent handling block triggers, in seconds
+	double maxRecycleTime;						// Worst block trigger, in seconds
+};
@@ -0,0 +1,46 @@
+#include "FTunnelProgressTracker.h"
+
+// Constructor
+FTunnelProgressTracker::FTunnelProgressTracker(): progress(0.0), nextTriggerDistance(0.0), triggerCount(0)
+{
+}
+
+// Public Functions
+void FTunnelProgressTracker::reset(double firstTriggerDistance)
+{
+	progress = 0.0;
+	nextTriggerDistance = firstTriggerDistance;
+	triggerCount = 0;
+}
+
+bool FTunnelProgressTracker::update(double runnerDistance)
+{
+	progress = runnerDistance;
+	return isTriggerPending();
+}
+
+bool FTunnelProgressTracker::isTriggerPending() const
+{
+	return progress >= nextTriggerDistance;
+}
+
+void FTunnelProgressTracker::advance(double segmentLength)
+{
+	nextTriggerDistance += FMath::Max(segmentLength, UE_KINDA_SMALL_NUMBER);		// A zero length block cannot stall the tracker
+	triggerCount++;
+}
+
+double FTunnelProgressTracker::getProgress() const
+{
+	return progress;
+}
+
+double FTunnelProgressTracker::getNextTriggerDistance() const
+{
+	return nextTriggerDistance;
+}
+
+int64 FTunnelProgressTracker::getTriggerCount() const
+{
+	return triggerCount;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class ORIONIX_API FTunnelProgressTracker
+{
+	/**
+	 * **FUNCTION DECLARATIONS**
+	 */
+public:
+	/**
+	 * @brief			Constructor of FTunnelProgressTracker class
+	 */
+	FTunnelProgressTracker();
+
+	/**
+	 * @brief			Starts tracking a new tunnel.
+	 * @param firstTriggerDistance	Distance along the tunnel axis where the first block ends.
+	 */
+	void reset(double firstTriggerDistance);
+
+	/**
+	 * @brief			Updates the runner position.
+	 * @param runnerDistance	Distance of the runner along the tunnel axis.
+	 * @return			Whether the runner has passed the next block end, see isTriggerPending.
+	 */
+	bool update(double runnerDistance);
+
+	/**
+	 * @brief			Returns whether the runner is past the next block end.
+	 *				The owner handles the trigger and calls advance until this is false,
+	 *				so no trigger is missed however far the runner moved in one frame.
+	 * @return			True if a trigger has to be handled
+	 */
+	bool isTriggerPending() const;
+
+	/**
+	 * @brief			Moves the next trigger to the end of the following block and counts the handled trigger.
+	 * @param segmentLength		Length of the block whose end was passed, blocks may have different lengths.
+	 */
+	void advance(double segmentLength);
+
+	/**
+	 * @brief			Returns the last runner distance along the tunnel axis
+	 * @return			Distance passed to the last update
+	 */
+	double getProgress() const;
+
+	/**
+	 * @brief			Returns the distance along the tunnel axis where the next block ends
+	 * @return			Distance of the next trigger
+	 */
+	double getNextTriggerDistance() const;
+
+	/**
+	 * @brief			Returns how many block ends were passed since the last reset
+	 * @return			Total number of triggers
+	 */
+	int64 getTriggerCount() const;
+
+	/**
+	 * **VARIABLE DECLARATIONS**
+	 */
+private:
+	double progress;					// Last runner distance along the tunnel axis
+	double nextTriggerDistance;				// Distance where the next block ends
+	int64 triggerCount;					// Number of block ends passed since the last reset
+};
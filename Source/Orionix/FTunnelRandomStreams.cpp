@@ -0,0 +1,31 @@
+#include "FTunnelRandomStreams.h"
+
+// Constructor
+FTunnelRandomStreams::FTunnelRandomStreams(): seed(0)
+{
+}
+
+// Public Functions
+void FTunnelRandomStreams::initialize(int32 newSeed)
+{
+	seed = newSeed;
+	for(int32 stream = 0; stream < (int32)ETunnelRandomStream::Count; stream++)
+	{
+		streams[stream].Initialize(getStreamSeed((ETunnelRandomStream)stream));
+	}
+}
+
+int32 FTunnelRandomStreams::getSeed() const
+{
+	return seed;
+}
+
+int32 FTunnelRandomStreams::getStreamSeed(ETunnelRandomStream stream) const
+{
+	return (int32)HashCombine(GetTypeHash(seed), GetTypeHash((int32)stream + 1));
+}
+
+FRandomStream &FTunnelRandomStreams::get(ETunnelRandomStream stream)
+{
+	return streams[(int32)stream];
+}
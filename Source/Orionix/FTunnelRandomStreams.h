@@ -0,0 +1,64 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * @brief			Subsystems with their own random stream.
+ */
+enum class ETunnelRandomStream : uint8
+{
+	Sequence,									// Block types, rolls and turns of FTunnelSequenceGenerator
+	Pool,										// Block picks and growth of FBlockPool
+	Tunnel,										// Game thread picks of ATunnelManager
+	Count
+};
+
+/**
+ * @brief			One seeded FRandomStream per subsystem, all derived from a single seed.
+ *				A subsystem drawing more or fewer numbers never shifts the numbers of another one,
+ *				so the same seed always gives the same tunnel.
+ */
+class ORIONIX_API FTunnelRandomStreams
+{
+	/**
+	 * **FUNCTION DECLARATIONS**
+	 */
+public:
+	/**
+	 * @brief			Constructor of FTunnelRandomStreams class
+	 */
+	FTunnelRandomStreams();
+
+	/**
+	 * @brief			Seeds every stream from the given seed.
+	 * @param newSeed		Seed of the run.
+	 */
+	void initialize(int32 newSeed);
+
+	/**
+	 * @brief			Returns the seed given to initialize
+	 * @return			Seed of the run
+	 */
+	int32 getSeed() const;
+
+	/**
+	 * @brief			Returns the seed a subsystem stream was initialized with
+	 * @param stream		The subsystem
+	 * @return			Seed of the subsystem stream
+	 */
+	int32 getStreamSeed(ETunnelRandomStream stream) const;
+
+	/**
+	 * @brief			Returns the stream of a subsystem
+	 * @param stream		The subsystem
+	 * @return			Random stream of the subsystem
+	 */
+	FRandomStream &get(ETunnelRandomStream stream);
+
+	/**
+	 * **VARIABLE DECLARATIONS**
+	 */
+private:
+	int32 seed;						// Seed of the run
+	FRandomStream streams[(int32)ETunnelRandomStream::Count];	// Stream of every subsystem
+};
@@ -0,0 +1,150 @@
+#include "FTunnelReplay.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+// Constructor
+FTunnelReplay::FTunnelReplay(): mode(ETunnelReplayMode::None), seed(0), nextInput(0), segmentCount(0), blockChecksum(0), recordedSegmentCount(0), recordedChecksum(0)
+{
+}
+
+// Public Functions
+void FTunnelReplay::startRecording(int32 newSeed)
+{
+	mode = ETunnelReplayMode::Recording;
+	seed = newSeed;
+	inputs.Reset();
+	nextInput = 0;
+	segmentCount = 0;
+	blockChecksum = 0;
+}
+
+bool FTunnelReplay::startPlayback(const FString &path)
+{
+	TArray<uint8> data;
+	if(!FFileHelper::LoadFileToArray(data, *path))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Cannot read replay %s"), *path);
+		return false;
+	}
+
+	FMemoryReader reader(data);
+	if(!serialize(reader))
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s is not a replay of this version"), *path);
+		return false;
+	}
+
+	mode = ETunnelReplayMode::Playback;
+	nextInput = 0;
+	segmentCount = 0;
+	blockChecksum = 0;
+	UE_LOG(LogTemp, Log, TEXT("Playing back replay %s: seed %d, %d inputs, %u blocks"), *path, seed, inputs.Num(), recordedSegmentCount);
+	return true;
+}
+
+bool FTunnelReplay::save(const FString &path)
+{
+	if(mode != ETunnelReplayMode::Recording)
+	{
+		return false;
+	}
+
+	recordedSegmentCount = segmentCount;
+	recordedChecksum = blockChecksum;
+
+	TArray<uint8> data;
+	FMemoryWriter writer(data);
+	serialize(writer);
+	if(!FFileHelper::SaveArrayToFile(data, *path))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Cannot write replay %s"), *path);
+		return false;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Replay saved to %s: seed %d, %d inputs, %u blocks, %d bytes"), *path, seed, inputs.Num(), recordedSegmentCount, data.Num());
+	return true;
+}
+
+void FTunnelReplay::recordInput(uint32 step, float time, ETunnelTurn turn)
+{
+	if(mode == ETunnelReplayMode::Recording)
+	{
+		inputs.Add({step, time, turn});
+	}
+}
+
+void FTunnelReplay::recordSegment(int32 meshIndex)
+{
+	if(mode == ETunnelReplayMode::None || (mode == ETunnelReplayMode::Playback && segmentCount >= recordedSegmentCount))
+	{
+		return;										// Playback only compares the blocks the recording placed
+	}
+
+	blockChecksum = FCrc::MemCrc32(&meshIndex, sizeof(meshIndex), blockChecksum);
+	segmentCount++;
+}
+
+ETunnelTurn FTunnelReplay::pollInput(uint32 step)
+{
+	if(mode != ETunnelReplayMode::Playback || nextInput >= inputs.Num() || inputs[nextInput].step > step)
+	{
+		return ETunnelTurn::None;
+	}
+	return inputs[nextInput++].turn;
+}
+
+bool FTunnelReplay::isPlaybackComplete() const
+{
+	return mode == ETunnelReplayMode::Playback && nextInput >= inputs.Num() && segmentCount >= recordedSegmentCount;
+}
+
+bool FTunnelReplay::verifyPlayback() const
+{
+	bool identical = segmentCount == recordedSegmentCount && blockChecksum == recordedChecksum;
+	UE_LOG(LogTemp, Warning, TEXT("Replay playback %s: %u blocks, checksum %08x, recorded %08x"),
+		identical ? TEXT("reproduced the recorded block sequence") : TEXT("DIVERGED from the recorded block sequence"), segmentCount, blockChecksum, recordedChecksum);
+	return identical;
+}
+
+ETunnelReplayMode FTunnelReplay::getMode() const
+{
+	return mode;
+}
+
+int32 FTunnelReplay::getSeed() const
+{
+	return seed;
+}
+
+// Private Functions
+bool FTunnelReplay::serialize(FArchive &Ar)
+{
+	uint32 magic = replayMagic;
+	uint16 version = replayVersion;
+	Ar << magic << version;
+	if(magic != replayMagic || version != replayVersion)
+	{
+		return false;
+	}
+
+	int32 inputCount = inputs.Num();
+	Ar << seed << recordedSegmentCount << recordedChecksum << inputCount;
+	if(Ar.IsLoading())
+	{
+		const int64 inputBytes = sizeof(uint32) + sizeof(uint8) + sizeof(float);
+		if(Ar.IsError() || inputCount < 0 || inputCount * inputBytes > Ar.TotalSize() - Ar.Tell())	// A truncated file cannot claim more inputs than it holds
+		{
+			return false;
+		}
+		inputs.SetNum(inputCount);
+	}
+
+	for(FTunnelReplayInput &input : inputs)
+	{
+		uint8 turn = (uint8)input.turn;
+		Ar << input.step << turn << input.time;
+		input.turn = (ETunnelTurn)turn;
+	}
+	return !Ar.IsError();
+}
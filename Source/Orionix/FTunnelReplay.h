@@ -0,0 +1,130 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FTunnelSequenceGenerator.h"
+
+/**
+ * @brief			What FTunnelReplay is doing with the current run.
+ */
+enum class ETunnelReplayMode : uint8
+{
+	None,
+	Recording,
+	Playback
+};
+
+/**
+ * @brief			One turn input of a replay.
+ */
+struct FTunnelReplayInput
+{
+	uint32 step = 0;					// Index of the first simulation step that sees the input
+	float time = 0.0f;					// Seconds since the tunnel started
+	ETunnelTurn turn = ETunnelTurn::None;			// Turn the player asked for
+};
+
+/**
+ * @brief			Records the seed and the timestamped turn inputs of a run into a compact binary file, and plays them back.
+ *				A checksum of the placed block types is stored with the inputs so playback can tell whether it reproduced the run.
+ *				File layout: magic, version, seed, segment count, block checksum, input count, then step, turn and time of every input.
+ */
+class ORIONIX_API FTunnelReplay
+{
+	/**
+	 * **FUNCTION DECLARATIONS**
+	 */
+public:
+	/**
+	 * @brief			Constructor of FTunnelReplay class
+	 */
+	FTunnelReplay();
+
+	/**
+	 * @brief			Starts recording a run.
+	 * @param newSeed		Seed the run was started with.
+	 */
+	void startRecording(int32 newSeed);
+
+	/**
+	 * @brief			Loads a replay file and starts playing it back.
+	 * @param path			Path of the replay file.
+	 * @return			False if the file cannot be read or is not a replay.
+	 */
+	bool startPlayback(const FString &path);
+
+	/**
+	 * @brief			Writes the recorded run to a replay file.
+	 * @param path			Path of the replay file.
+	 * @return			False if the file cannot be written.
+	 */
+	bool save(const FString &path);
+
+	/**
+	 * @brief			Records a turn input while recording.
+	 * @param step			Index of the first simulation step that sees the input.
+	 * @param time			Seconds since the tunnel started.
+	 * @param turn			Turn the player asked for.
+	 */
+	void recordInput(uint32 step, float time, ETunnelTurn turn);
+
+	/**
+	 * @brief			Adds a placed block to the block checksum. Called for every segment in both modes.
+	 * @param meshIndex		Block type of the segment.
+	 */
+	void recordSegment(int32 meshIndex);
+
+	/**
+	 * @brief			Returns the next recorded input that is due before a simulation step while playing back, and consumes it.
+	 * @param step			Index of the simulation step about to run.
+	 * @return			The turn of the input, or ETunnelTurn::None when no input is due.
+	 */
+	ETunnelTurn pollInput(uint32 step);
+
+	/**
+	 * @brief			Returns whether playback has replayed every input and placed as many blocks as the recording
+	 * @return			True once the playback can be verified
+	 */
+	bool isPlaybackComplete() const;
+
+	/**
+	 * @brief			Compares the block checksum of the playback with the recording and logs the result.
+	 * @return			True if the playback placed the same block sequence.
+	 */
+	bool verifyPlayback() const;
+
+	/**
+	 * @brief			Returns the current mode
+	 * @return			None, Recording or Playback
+	 */
+	ETunnelReplayMode getMode() const;
+
+	/**
+	 * @brief			Returns the seed of the recorded run
+	 * @return			Seed stored in the replay
+	 */
+	int32 getSeed() const;
+
+private:
+	/**
+	 * @brief			Reads or writes the replay, depending on the archive.
+	 * @param Ar			The archive.
+	 * @return			False if a loaded replay has an unknown format.
+	 */
+	bool serialize(FArchive &Ar);
+
+	/**
+	 * **VARIABLE DECLARATIONS**
+	 */
+private:
+	static constexpr uint32 replayMagic = 0x4C50524F;	// "ORPL"
+	static constexpr uint16 replayVersion = 2;		// Version of the file layout, 2 stamps inputs with the step that sees them
+
+	ETunnelReplayMode mode;					// What is done with the current run
+	int32 seed;						// Seed of the run
+	TArray<FTunnelReplayInput> inputs;			// Turn inputs, oldest first
+	int32 nextInput;					// Next input to be played back
+	uint32 segmentCount;					// Blocks placed in this run and added to blockChecksum
+	uint32 blockChecksum;					// Checksum of the block types placed in this run
+	uint32 recordedSegmentCount;				// Blocks placed by the recorded run
+	uint32 recordedChecksum;				// Checksum of the block types placed by the recorded run
+};
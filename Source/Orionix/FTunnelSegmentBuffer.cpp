@@ -0,0 +1,86 @@
+#include "FTunnelSegmentBuffer.h"
+
+// Constructor
+FTunnelSegmentBuffer::FTunnelSegmentBuffer(): firstSegmentNumber(0), count(0)
+{
+}
+
+// Public Functions
+void FTunnelSegmentBuffer::initialize(int32 capacity)
+{
+	segments.Reset();
+	segments.SetNum(FMath::Max(capacity, 1));
+	firstSegmentNumber = 0;
+	count = 0;
+}
+
+const FTunnelSegment *FTunnelSegmentBuffer::push(const FTunnelSegment &segment)
+{
+	if(count == segments.Num())
+	{
+		return nullptr;
+	}
+
+	int64 segmentNumber = firstSegmentNumber + count;
+	FTunnelSegment &storedSegment = segments[segmentNumber % segments.Num()];
+	storedSegment = segment;
+	storedSegment.segmentNumber = segmentNumber;
+	count++;
+	return &storedSegment;
+}
+
+FTunnelSegment FTunnelSegmentBuffer::pop()
+{
+	check(count > 0);
+	FTunnelSegment &segment = segments[firstSegmentNumber % segments.Num()];
+	FTunnelSegment removedSegment = segment;
+	segment = FTunnelSegment();
+	firstSegmentNumber++;
+	count--;
+	return removedSegment;
+}
+
+const FTunnelSegment &FTunnelSegmentBuffer::first() const
+{
+	return getAt(0);
+}
+
+const FTunnelSegment &FTunnelSegmentBuffer::last() const
+{
+	return getAt(count - 1);
+}
+
+const FTunnelSegment &FTunnelSegmentBuffer::getAt(int32 index) const
+{
+	check(index >= 0 && index < count);
+	return segments[(firstSegmentNumber + index) % segments.Num()];
+}
+
+const FTunnelSegment *FTunnelSegmentBuffer::findSegment(int64 segmentNumber) const
+{
+	if(segmentNumber < firstSegmentNumber || segmentNumber >= firstSegmentNumber + count)
+	{
+		return nullptr;
+	}
+	return &segments[segmentNumber % segments.Num()];
+}
+
+int64 FTunnelSegmentBuffer::getFirstSegmentNumber() const
+{
+	return firstSegmentNumber;
+}
+
+int32 FTunnelSegmentBuffer::num() const
+{
+	return count;
+}
+
+int32 FTunnelSegmentBuffer::getCapacity() const
+{
+	return segments.Num();
+}
+
+SIZE_T FTunnelSegmentBuffer::getAllocatedSize() const
+{
+	return segments.GetAllocatedSize();
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FTunnelSequenceGenerator.h"
+
+/**
+ * @brief			One block of the live tunnel.
+ */
+struct FTunnelSegment
+{
+	int32 meshIndex = INDEX_NONE;				// Block type of the segment
+	int32 rollSteps = 0;					// Roll of the block in quarter turns
+	FVector location = FVector::ZeroVector;			// Location of the block relative to the tunnelArrow
+	float length = 0.0f;					// Length of the block along the tunnel axis
+	ETunnelTurn turn = ETunnelTurn::None;			// Turn taken when the player reaches the segment
+	int64 segmentNumber = INDEX_NONE;			// Position of the segment in the whole tunnel sequence, the first block is 0
+};
+
+class ORIONIX_API FTunnelSegmentBuffer
+{
+	/**
+	 * **FUNCTION DECLARATIONS**
+	 */
+public:
+	/**
+	 * @brief			Constructor of FTunnelSegmentBuffer class
+	 */
+	FTunnelSegmentBuffer();
+
+	/**
+	 * @brief			Allocates the buffer once. Pushing and popping never allocate or move segments afterwards.
+	 * @param capacity		Maximum number of segments in the tunnel at the same time.
+	 */
+	void initialize(int32 capacity);
+
+	/**
+	 * @brief			Appends a segment after the newest one in O(1).
+	 * @param segment		The segment, its segment number is assigned by the buffer.
+	 * @return			The stored segment, or nullptr if the buffer is full.
+	 */
+	const FTunnelSegment *push(const FTunnelSegment &segment);
+
+	/**
+	 * @brief			Removes the oldest segment in O(1).
+	 * @return			The removed segment.
+	 */
+	FTunnelSegment pop();
+
+	/**
+	 * @brief			Returns the oldest segment. The buffer must not be empty.
+	 * @return			Oldest segment of the tunnel
+	 */
+	const FTunnelSegment &first() const;
+
+	/**
+	 * @brief			Returns the newest segment. The buffer must not be empty.
+	 * @return			Newest segment of the tunnel
+	 */
+	const FTunnelSegment &last() const;
+
+	/**
+	 * @brief			Returns a segment by its position in the buffer.
+	 * @param index			0 is the oldest segment, num() - 1 the newest.
+	 * @return			Corresponding segment
+	 */
+	const FTunnelSegment &getAt(int32 index) const;
+
+	/**
+	 * @brief			Returns a segment by its position in the whole tunnel sequence.
+	 * @param segmentNumber		Segment number given when the segment was pushed.
+	 * @return			The segment, or nullptr if it is not in the tunnel anymore or not yet.
+	 */
+	const FTunnelSegment *findSegment(int64 segmentNumber) const;
+
+	/**
+	 * @brief			Returns the segment number of the oldest segment
+	 * @return			Segment number the next pop removes
+	 */
+	int64 getFirstSegmentNumber() const;
+
+	/**
+	 * @brief			Returns the number of segments in the tunnel
+	 * @return			Number of segments
+	 */
+	int32 num() const;
+
+	/**
+	 * @brief			Returns the maximum number of segments
+	 * @return			Capacity given to initialize
+	 */
+	int32 getCapacity() const;
+
+	/**
+	 * @brief			Returns the memory allocated for the segments
+	 * @return			Allocated size in bytes
+	 */
+	SIZE_T getAllocatedSize() const;
+
+	/**
+	 * **VARIABLE DECLARATIONS**
+	 */
+private:
+	TArray<FTunnelSegment> segments;			// Segment storage, a segment lives in slot segmentNumber % capacity
+	int64 firstSegmentNumber;				// Segment number of the oldest segment
+	int32 count;						// Number of segments in the tunnel
+};
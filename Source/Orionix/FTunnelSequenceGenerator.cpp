@@ -0,0 +1,114 @@
+#include "FTunnelSequenceGenerator.h"
+
+// Constructor
+FTunnelSequenceGenerator::FTunnelSequenceGenerator(): queuedCount(0), stopRequested(false)
+{
+}
+
+// Destructor
+FTunnelSequenceGenerator::~FTunnelSequenceGenerator()
+{
+	stop();
+}
+
+// Public Functions
+void FTunnelSequenceGenerator::start(const TArray<float> &blockWeights, const FTunnelSequenceRules &sequenceRules, int32 seed)
+{
+	stop();
+	descriptors.Empty();
+	queuedCount = 0;
+
+	blockSampler.build(blockWeights);
+	randomStream.Initialize(seed);
+	rules = sequenceRules;
+	rules.lookahead = FMath::Max(rules.lookahead, 2);
+	lastMeshIndex = INDEX_NONE;
+	segmentsSinceTurn = 0;
+	nextSequenceNumber = 0;
+	consumedCount = 0;
+	starvedCount = 0;
+
+	generate(rules.lookahead);								// No task is running yet, the first tunnel is built from these
+}
+
+void FTunnelSequenceGenerator::stop()
+{
+	stopRequested = true;
+	generationTask.Wait();
+	stopRequested = false;
+}
+
+bool FTunnelSequenceGenerator::peek(FTunnelSegmentDescriptor &outDescriptor)
+{
+	return descriptors.Peek(outDescriptor);
+}
+
+void FTunnelSequenceGenerator::pop()
+{
+	if(!descriptors.Pop())
+	{
+		return;
+	}
+	queuedCount--;
+	consumedCount++;
+
+	int32 missingCount = rules.lookahead - queuedCount;
+	if(missingCount >= rules.lookahead / 2 && generationTask.IsCompleted())		// Only one producer at a time
+	{
+		generationTaskCount++;
+		generationTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, missingCount]()
+		{
+			generate(missingCount);
+		});
+	}
+}
+
+void FTunnelSequenceGenerator::recordStarvation()
+{
+	starvedCount++;
+}
+
+int32 FTunnelSequenceGenerator::getQueuedCount() const
+{
+	return queuedCount;
+}
+
+void FTunnelSequenceGenerator::logStatus() const
+{
+	UE_LOG(LogTemp, Warning, TEXT("Sequence Lookahead: %d/%d, Consumed: %lld, Starved: %lld, Generation tasks: %d"),
+		getQueuedCount(), rules.lookahead, consumedCount, starvedCount, generationTaskCount);
+}
+
+// Private Functions
+void FTunnelSequenceGenerator::generate(int32 count)
+{
+	for(int32 i = 0; i < count && !stopRequested; i++)
+	{
+		descriptors.Enqueue(generateNext());
+		queuedCount++;
+	}
+}
+
+FTunnelSegmentDescriptor FTunnelSequenceGenerator::generateNext()
+{
+	FTunnelSegmentDescriptor descriptor;
+	descriptor.sequenceNumber = nextSequenceNumber++;
+
+	const int32 maxRepeatRetries = 4;							// Gives up when a single block type is selectable
+	descriptor.meshIndex = blockSampler.sample(randomStream);
+	for(int32 retry = 0; rules.bAvoidRepeats && retry < maxRepeatRetries && descriptor.meshIndex != INDEX_NONE && descriptor.meshIndex == lastMeshIndex; retry++)
+	{
+		descriptor.meshIndex = blockSampler.sample(randomStream);
+	}
+	lastMeshIndex = descriptor.meshIndex;
+
+	descriptor.rollSteps = randomStream.RandRange(0, 3);
+
+	segmentsSinceTurn++;
+	if(rules.turnChance > 0.0f && segmentsSinceTurn >= rules.minTurnSpacing && randomStream.FRand() < rules.turnChance)
+	{
+		descriptor.turn = randomStream.RandRange(0, 1) == 0 ? ETunnelTurn::Left : ETunnelTurn::Right;
+		segmentsSinceTurn = 0;
+	}
+	return descriptor;
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "Tasks/Task.h"
+#include "FAliasSampler.h"
+#include <atomic>
+
+/**
+ * @brief			Turn the tunnel takes when the player reaches a segment.
+ */
+enum class ETunnelTurn : uint8
+{
+	None,
+	Left,
+	Right
+};
+
+/**
+ * @brief			Everything the tunnel needs to know about a segment before a block is taken for it.
+ */
+struct FTunnelSegmentDescriptor
+{
+	int32 meshIndex = INDEX_NONE;				// Block type of the segment, INDEX_NONE lets the pool pick one
+	int32 rollSteps = 0;					// Roll of the block in quarter turns, 0 to 3
+	ETunnelTurn turn = ETunnelTurn::None;			// Turn taken when the player reaches the segment
+	int64 sequenceNumber = INDEX_NONE;			// Position of the descriptor in the generated sequence
+};
+
+/**
+ * @brief			Generation rules of FTunnelSequenceGenerator.
+ */
+struct FTunnelSequenceRules
+{
+	int32 lookahead = 32;					// Number of descriptors kept ready for the game thread
+	bool bAvoidRepeats = true;				// The same block type never comes twice in a row
+	float turnChance = 0.0f;				// Chance of a segment carrying a turn
+	int32 minTurnSpacing = 6;				// Minimum number of segments between two turns
+};
+
+/**
+ * @brief			Generates the tunnel sequence ahead of the player on a UE::Tasks worker.
+ *				The worker is the only producer and the game thread the only consumer of a lock-free SPSC queue,
+ *				so generation rules can get as expensive as needed without costing frame time.
+ *				At most one generation task runs at a time; it owns the random stream and the rule state while it runs.
+ */
+class ORIONIX_API FTunnelSequenceGenerator
+{
+	/**
+	 * **FUNCTION DECLARATIONS**
+	 */
+public:
+	/**
+	 * @brief			Constructor of FTunnelSequenceGenerator class
+	 */
+	FTunnelSequenceGenerator();
+
+	/**
+	 * @brief			Destructor of FTunnelSequenceGenerator class, waits for the generation task
+	 */
+	~FTunnelSequenceGenerator();
+
+	/**
+	 * @brief			Stops any running generation, then fills the lookahead on the calling thread so the tunnel can be built right away.
+	 * @param blockWeights		Selection weight of every block type, as used by FBlockPool.
+	 * @param sequenceRules		Generation rules.
+	 * @param seed			Seed of the random stream the sequence is generated from.
+	 */
+	void start(const TArray<float> &blockWeights, const FTunnelSequenceRules &sequenceRules, int32 seed);
+
+	/**
+	 * @brief			Asks the generation task to stop and waits for it.
+	 */
+	void stop();
+
+	/**
+	 * @brief			Returns the next descriptor without consuming it. Game thread only.
+	 * @param outDescriptor		Filled with the next descriptor.
+	 * @return			False if the worker has fallen behind and no descriptor is ready.
+	 */
+	bool peek(FTunnelSegmentDescriptor &outDescriptor);
+
+	/**
+	 * @brief			Consumes the next descriptor and starts a generation task when the lookahead runs low. Game thread only.
+	 */
+	void pop();
+
+	/**
+	 * @brief			Counts a segment the game thread had to pick itself because no descriptor was ready.
+	 */
+	void recordStarvation();
+
+	/**
+	 * @brief			Returns the number of descriptors ready for the game thread
+	 * @return			Number of queued descriptors
+	 */
+	int32 getQueuedCount() const;
+
+	/**
+	 * @brief			Logs the generated, consumed and starved counters.
+	 */
+	void logStatus() const;
+
+private:
+	/**
+	 * @brief			Generates descriptors into the queue. Runs on the generation task, or on the game thread in start.
+	 * @param count			Number of descriptors to generate.
+	 */
+	void generate(int32 count);
+
+	/**
+	 * @brief			Applies the generation rules to produce the next descriptor.
+	 * @return			The next descriptor of the sequence.
+	 */
+	FTunnelSegmentDescriptor generateNext();
+
+	/**
+	 * **VARIABLE DECLARATIONS**
+	 */
+private:
+	TQueue<FTunnelSegmentDescriptor, EQueueMode::Spsc> descriptors;	// Produced by the generation task, consumed by the game thread
+	std::atomic<int32> queuedCount;				// Number of descriptors in the queue
+	std::atomic<bool> stopRequested;			// Set to end the generation task early
+	UE::Tasks::FTask generationTask;			// Running or last generation task
+
+	// Owned by the generation task while it runs
+	FAliasSampler blockSampler;				// Weighted block type selection
+	FRandomStream randomStream;				// Random numbers of the sequence
+	FTunnelSequenceRules rules;				// Generation rules
+	int32 lastMeshIndex = INDEX_NONE;			// Block type of the last descriptor
+	int32 segmentsSinceTurn = 0;				// Descriptors since the last turn
+	int64 nextSequenceNumber = 0;				// Sequence number of the next descriptor
+
+	// Game thread
+	int64 consumedCount = 0;				// Number of descriptors consumed
+	int64 starvedCount = 0;					// Number of segments picked without a descriptor
+	int32 generationTaskCount = 0;				// Number of generation tasks launched
+};
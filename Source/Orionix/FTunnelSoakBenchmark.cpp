@@ -0,0 +1,212 @@
+#include "FTunnelSoakBenchmark.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include <atomic>
+
+/**
+ * @brief			Forwards every call to the engine allocator and counts the allocations.
+ *				Installed by the module startup of a soak run, before the tunnel runs, and kept for the life of the process;
+ *				memory allocated before it is freed through it like any other. Runs without -OrionixSoak never install it.
+ */
+class FCountingMalloc final: public FMalloc
+{
+public:
+	explicit FCountingMalloc(FMalloc *innerMalloc): inner(innerMalloc) {}
+
+	virtual void *Malloc(SIZE_T Count, uint32 Alignment) override { allocationCount.fetch_add(1, std::memory_order_relaxed); return inner->Malloc(Count, Alignment); }
+	virtual void *TryMalloc(SIZE_T Count, uint32 Alignment) override { allocationCount.fetch_add(1, std::memory_order_relaxed); return inner->TryMalloc(Count, Alignment); }
+	virtual void *Realloc(void *Original, SIZE_T Count, uint32 Alignment) override { allocationCount.fetch_add(1, std::memory_order_relaxed); return inner->Realloc(Original, Count, Alignment); }
+	virtual void *TryRealloc(void *Original, SIZE_T Count, uint32 Alignment) override { allocationCount.fetch_add(1, std::memory_order_relaxed); return inner->TryRealloc(Original, Count, Alignment); }
+	virtual void Free(void *Original) override { inner->Free(Original); }
+	virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return inner->QuantizeSize(Count, Alignment); }
+	virtual bool GetAllocationSize(void *Original, SIZE_T &SizeOut) override { return inner->GetAllocationSize(Original, SizeOut); }
+	virtual void Trim(bool bTrimThreadCaches) override { inner->Trim(bTrimThreadCaches); }
+	virtual void SetupTLSCachesOnCurrentThread() override { inner->SetupTLSCachesOnCurrentThread(); }
+	virtual void ClearAndDisableTLSCachesOnCurrentThread() override { inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+	virtual void InitializeStatsMetadata() override { inner->InitializeStatsMetadata(); }
+	virtual void UpdateStats() override { inner->UpdateStats(); }
+	virtual void GetAllocatorStats(FGenericMemoryStats &OutStats) override { inner->GetAllocatorStats(OutStats); }
+	virtual void DumpAllocatorStats(FOutputDevice &Ar) override { inner->DumpAllocatorStats(Ar); }
+	virtual bool IsInternallyThreadSafe() const override { return inner->IsInternallyThreadSafe(); }
+	virtual bool ValidateHeap() override { return inner->ValidateHeap(); }
+	virtual const TCHAR *GetDescriptiveName() override { return inner->GetDescriptiveName(); }
+
+	static std::atomic<uint64> allocationCount;					// Allocations made through the allocator since it was installed
+
+private:
+	FMalloc *inner;									// Engine allocator
+};
+
+std::atomic<uint64> FCountingMalloc::allocationCount(0);
+static bool countingMallocInstalled = false;
+
+// Constructor
+FTunnelSoakBenchmark::FTunnelSoakBenchmark(): running(false), targetRecycles(0), lastFrameTime(0.0), lastAllocationCount(0), frameRecycles(0), peakUsedPhysical(0)
+{
+}
+
+// Public Functions
+bool FTunnelSoakBenchmark::installAllocationCounter()
+{
+	int64 soakRecycles = 0;
+	if(countingMallocInstalled || !GMalloc || !FParse::Value(FCommandLine::Get(), TEXT("OrionixSoak="), soakRecycles) || soakRecycles <= 0)
+	{
+		return countingMallocInstalled;
+	}
+
+	FCountingMalloc *countingMalloc = new FCountingMalloc(GMalloc);				// Leaked on purpose, allocations may still be freed through it at exit
+	FPlatformMisc::MemoryBarrier();								// Fully constructed before any thread can see it
+	GMalloc = countingMalloc;
+	countingMallocInstalled = true;
+	return true;
+}
+
+bool FTunnelSoakBenchmark::initialize()
+{
+	if(!FParse::Value(FCommandLine::Get(), TEXT("OrionixSoak="), targetRecycles) || targetRecycles <= 0)
+	{
+		return false;
+	}
+
+	if(!FParse::Value(FCommandLine::Get(), TEXT("OrionixSoakReport="), reportPath))
+	{
+		reportPath = FPaths::Combine(FPaths::ProfilingDir(), FString::Printf(TEXT("OrionixSoak-%s"), *FDateTime::Now().ToString()));
+	}
+	if(!FParse::Value(FCommandLine::Get(), TEXT("OrionixSoakLabel="), label))
+	{
+		label = FApp::GetBuildVersion();
+	}
+
+	if(!countingMallocInstalled)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Soak benchmark: the allocation counter was not installed at startup, allocations are reported as 0"));
+	}
+
+	running = true;
+	frames.Reset();
+	recycleSeconds.Reset((int32)FMath::Min<int64>(targetRecycles, MAX_int32));	// Recording a recycle never allocates
+	lastFrameTime = 0.0;
+	frameRecycles = 0;
+	peakUsedPhysical = 0;
+	UE_LOG(LogTemp, Log, TEXT("Soak benchmark: %lld recycles, report %s"), targetRecycles, *reportPath);
+	return true;
+}
+
+bool FTunnelSoakBenchmark::isRunning() const
+{
+	return running;
+}
+
+void FTunnelSoakBenchmark::tickFrame()
+{
+	if(!running)
+	{
+		return;
+	}
+
+	double now = FPlatformTime::Seconds();
+	uint64 allocationCount = FCountingMalloc::allocationCount.load(std::memory_order_relaxed);
+	if(lastFrameTime > 0.0)
+	{
+		FPlatformMemoryStats memoryStats = FPlatformMemory::GetStats();
+		FTunnelSoakFrame &frame = frames.AddDefaulted_GetRef();
+		frame.frameSeconds = (float)(now - lastFrameTime);
+		frame.recycles = frameRecycles;
+		frame.allocations = (int32)FMath::Min<uint64>(allocationCount - lastAllocationCount, MAX_int32);
+		frame.usedPhysical = memoryStats.UsedPhysical;
+		peakUsedPhysical = FMath::Max<uint64>(peakUsedPhysical, FMath::Max<uint64>(memoryStats.UsedPhysical, memoryStats.PeakUsedPhysical));
+	}
+
+	lastFrameTime = now;
+	lastAllocationCount = allocationCount;
+	frameRecycles = 0;
+}
+
+void FTunnelSoakBenchmark::recordRecycle(double seconds)
+{
+	if(running)
+	{
+		recycleSeconds.Add(seconds);
+		frameRecycles++;
+	}
+}
+
+bool FTunnelSoakBenchmark::isComplete() const
+{
+	return running && recycleSeconds.Num() >= targetRecycles;
+}
+
+bool FTunnelSoakBenchmark::writeReport() const
+{
+	TArray<double> frameMs;
+	TArray<double> allocations;
+	frameMs.Reserve(frames.Num());
+	allocations.Reserve(frames.Num());
+	FString csv = TEXT("frame,frame_ms,recycles,allocations,used_physical_mb\n");
+	for(int32 i = 0; i < frames.Num(); i++)
+	{
+		const FTunnelSoakFrame &frame = frames[i];
+		frameMs.Add(frame.frameSeconds * 1000.0);
+		allocations.Add(frame.allocations);
+		csv += FString::Printf(TEXT("%d,%.4f,%d,%d,%.2f\n"), i, frame.frameSeconds * 1000.0, frame.recycles, frame.allocations, frame.usedPhysical / (1024.0 * 1024.0));
+	}
+
+	TArray<double> recycleUs;
+	recycleUs.Reserve(recycleSeconds.Num());
+	for(double seconds : recycleSeconds)
+	{
+		recycleUs.Add(seconds * 1000000.0);
+	}
+	frameMs.Sort();
+	allocations.Sort();
+	recycleUs.Sort();
+
+	double totalAllocations = 0.0;
+	for(double frameAllocations : allocations)
+	{
+		totalAllocations += frameAllocations;
+	}
+
+	FString json = FString::Printf(TEXT("{\n")
+		TEXT("\t\"label\": \"%s\",\n")
+		TEXT("\t\"platform\": \"%s\",\n")
+		TEXT("\t\"frames\": %d,\n")
+		TEXT("\t\"recycles\": %d,\n")
+		TEXT("\t\"frame_ms\": {\"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f},\n")
+		TEXT("\t\"recycle_us\": {\"p50\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"max\": %.3f},\n")
+		TEXT("\t\"allocations_per_frame\": {\"mean\": %.2f, \"p50\": %.0f, \"p99\": %.0f, \"max\": %.0f},\n")
+		TEXT("\t\"peak_used_physical_mb\": %.2f\n")
+		TEXT("}\n"),
+		*label.ReplaceCharWithEscapedChar(), FPlatformProperties::IniPlatformName(), frames.Num(), recycleUs.Num(),
+		getPercentile(frameMs, 50), getPercentile(frameMs, 95), getPercentile(frameMs, 99), getPercentile(frameMs, 100),
+		getPercentile(recycleUs, 50), getPercentile(recycleUs, 95), getPercentile(recycleUs, 99), getPercentile(recycleUs, 100),
+		allocations.Num() > 0 ? totalAllocations / allocations.Num() : 0.0, getPercentile(allocations, 50), getPercentile(allocations, 99), getPercentile(allocations, 100),
+		peakUsedPhysical / (1024.0 * 1024.0));
+
+	bool written = FFileHelper::SaveStringToFile(json, *(reportPath + TEXT(".json"))) && FFileHelper::SaveStringToFile(csv, *(reportPath + TEXT(".csv")));
+	UE_LOG(LogTemp, Warning, TEXT("Soak benchmark: %d frames, %d recycles, Frame p50/p95/p99/max: %.2f/%.2f/%.2f/%.2f ms, Recycle p50/p99/max: %.2f/%.2f/%.2f us, Peak memory: %.1f MB"),
+		frames.Num(), recycleUs.Num(), getPercentile(frameMs, 50), getPercentile(frameMs, 95), getPercentile(frameMs, 99), getPercentile(frameMs, 100),
+		getPercentile(recycleUs, 50), getPercentile(recycleUs, 99), getPercentile(recycleUs, 100), peakUsedPhysical / (1024.0 * 1024.0));
+	if(!written)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Cannot write soak report %s"), *reportPath);
+	}
+	return written;
+}
+
+// Private Functions
+double FTunnelSoakBenchmark::getPercentile(const TArray<double> &sortedSamples, double percentile)
+{
+	if(sortedSamples.Num() == 0)
+	{
+		return 0.0;
+	}
+	int32 rank = FMath::CeilToInt32(percentile / 100.0 * sortedSamples.Num());
+	return sortedSamples[FMath::Clamp(rank - 1, 0, sortedSamples.Num() - 1)];
+}
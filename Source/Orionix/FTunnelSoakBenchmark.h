@@ -0,0 +1,101 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * @brief			One game thread frame of a soak run.
+ */
+struct FTunnelSoakFrame
+{
+	float frameSeconds = 0.0f;				// Wall clock time since the previous frame
+	int32 recycles = 0;					// Block recycles handled in the frame
+	int32 allocations = 0;					// Heap allocations made in the frame, by any thread
+	uint64 usedPhysical = 0;				// Physical memory used by the process at the end of the frame, in bytes
+};
+
+/**
+ * @brief			Soak benchmark of the tunnel. Started with -OrionixSoak=<recycles> on a headless run, e.g.
+ *				Orionix <map> -game -nullrhi -OrionixSoak=10000 [-OrionixSoakReport=<path>] [-OrionixSoakLabel=<build>]
+ *				It records the frame time, block recycle cost, allocations and memory of every frame until the tunnel
+ *				has recycled the requested number of blocks, then writes <path>.json with the percentiles and <path>.csv
+ *				with every frame, so runs of different builds can be compared.
+ */
+class ORIONIX_API FTunnelSoakBenchmark
+{
+	/**
+	 * **FUNCTION DECLARATIONS**
+	 */
+public:
+	/**
+	 * @brief			Constructor of FTunnelSoakBenchmark class
+	 */
+	FTunnelSoakBenchmark();
+
+	/**
+	 * @brief			Wraps the engine allocator in a counting proxy if the command line asks for a soak run.
+	 *				Called once from the module startup, while the engine is still loading, so the allocator is never
+	 *				swapped while the tunnel runs and runs without -OrionixSoak keep the engine allocator untouched.
+	 * @return			Whether the allocations are counted.
+	 */
+	static bool installAllocationCounter();
+
+	/**
+	 * @brief			Starts the benchmark if the command line asks for it.
+	 *				Allocations are only counted if installAllocationCounter ran at startup.
+	 * @return			Whether a soak run was started.
+	 */
+	bool initialize();
+
+	/**
+	 * @brief			Returns whether a soak run is in progress or finished
+	 * @return			True if initialize started a soak run
+	 */
+	bool isRunning() const;
+
+	/**
+	 * @brief			Closes the previous frame. Called once at the start of every game thread frame.
+	 */
+	void tickFrame();
+
+	/**
+	 * @brief			Records the cost of one block recycle.
+	 * @param seconds		Time the recycle took.
+	 */
+	void recordRecycle(double seconds);
+
+	/**
+	 * @brief			Returns whether the requested number of recycles has been reached
+	 * @return			True once the report can be written
+	 */
+	bool isComplete() const;
+
+	/**
+	 * @brief			Writes the JSON summary and the CSV frame log and logs the summary.
+	 * @return			False if a file cannot be written.
+	 */
+	bool writeReport() const;
+
+private:
+	/**
+	 * @brief			Returns a percentile of the samples.
+	 * @param sortedSamples		Samples sorted in ascending order.
+	 * @param percentile		Percentile, 0 to 100.
+	 * @return			The nearest rank sample, 0 without samples.
+	 */
+	static double getPercentile(const TArray<double> &sortedSamples, double percentile);
+
+	/**
+	 * **VARIABLE DECLARATIONS**
+	 */
+private:
+	bool running;						// Whether a soak run was started
+	int64 targetRecycles;					// Recycles after which the run is complete
+	FString reportPath;					// Report path without extension
+	FString label;						// Build label written to the report
+	TArray<FTunnelSoakFrame> frames;			// Every frame since the first one
+	TArray<double> recycleSeconds;				// Cost of every recycle
+	double lastFrameTime;					// Wall clock time the current frame started, 0 before the first frame
+	uint64 lastAllocationCount;				// Allocation counter when the current frame started
+	int32 frameRecycles;					// Recycles handled in the current frame
+	uint64 peakUsedPhysical;				// Highest physical memory used by the process, in bytes
+};
@@ -0,0 +1,88 @@
+#include "FTunnelStreamingPrefetch.h"
+#include "Materials/MaterialInterface.h"
+#include "Engine/Texture.h"
+
+// Constructor
+FTunnelStreamingPrefetch::FTunnelStreamingPrefetch(): prefetchCount(0), shownCount(0), nonResidentShownCount(0)
+{
+}
+
+// Public Functions
+void FTunnelStreamingPrefetch::initialize(int32 meshCount)
+{
+	meshAssets.Reset();
+	meshAssets.SetNum(meshCount);
+	prefetchCount = 0;
+	shownCount = 0;
+	nonResidentShownCount = 0;
+}
+
+void FTunnelStreamingPrefetch::prefetch(int32 meshIndex, UStaticMesh *mesh, float seconds)
+{
+	for(const TWeakObjectPtr<UStreamableRenderAsset> &asset : getStreamingAssets(meshIndex, mesh))
+	{
+		if(asset.IsValid())
+		{
+			asset->SetForceMipLevelsToBeResident(seconds);
+		}
+	}
+	prefetchCount++;
+}
+
+bool FTunnelStreamingPrefetch::recordShown(int32 meshIndex, UStaticMesh *mesh)
+{
+	bool bResident = true;
+	for(const TWeakObjectPtr<UStreamableRenderAsset> &asset : getStreamingAssets(meshIndex, mesh))
+	{
+		if(asset.IsValid())
+		{
+			const FStreamableRenderResourceState &state = asset->GetStreamableResourceState();
+			int32 fullLODs = FMath::Min<int32>(state.MaxNumLODs - state.AssetLODBias, state.NumNonOptionalLODs);	// Optional LODs may never be installed
+			bResident &= !state.bSupportsStreaming || state.NumResidentLODs >= fullLODs;	// The streamer may not have requested them yet
+		}
+	}
+
+	shownCount++;
+	nonResidentShownCount += bResident ? 0 : 1;
+	return bResident;
+}
+
+int64 FTunnelStreamingPrefetch::getNonResidentShownCount() const
+{
+	return nonResidentShownCount;
+}
+
+void FTunnelStreamingPrefetch::logStatus() const
+{
+	UE_LOG(LogTemp, Warning, TEXT("Streaming Prefetch: %lld hints, Segments Shown: %lld, Shown Non-Resident: %lld (%.1f%%)"),
+		prefetchCount, shownCount, nonResidentShownCount, shownCount > 0 ? nonResidentShownCount * 100.0 / shownCount : 0.0);
+}
+
+// Private Functions
+const TArray<TWeakObjectPtr<UStreamableRenderAsset>> &FTunnelStreamingPrefetch::getStreamingAssets(int32 meshIndex, UStaticMesh *mesh)
+{
+	if(!meshAssets.IsValidIndex(meshIndex) || !mesh)
+	{
+		return noAssets;
+	}
+
+	FMeshStreamingAssets &streamingAssets = meshAssets[meshIndex];
+	if(!streamingAssets.bGathered)
+	{
+		streamingAssets.bGathered = true;
+		streamingAssets.assets.Add(mesh);
+		TArray<UTexture *> textures;
+		for(const FStaticMaterial &staticMaterial : mesh->GetStaticMaterials())
+		{
+			if(staticMaterial.MaterialInterface)
+			{
+				staticMaterial.MaterialInterface->GetUsedTextures(textures, EMaterialQualityLevel::Num, true, GMaxRHIFeatureLevel, true);
+				for(UTexture *texture : textures)
+				{
+					streamingAssets.assets.AddUnique(texture);
+				}
+			}
+		}
+	}
+	return streamingAssets.assets;
+}
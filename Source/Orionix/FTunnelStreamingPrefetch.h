@@ -0,0 +1,82 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/StaticMesh.h"
+
+/**
+ * @brief			Streaming hints for the blocks the tunnel is about to show. The mesh LODs and texture mips of a block type
+ *				are forced resident ahead of time, instead of the streamer reacting once the block is on screen, and every
+ *				segment shown while its assets were still streaming in is counted as a pop-in.
+ *				The streamed assets of a mesh type, the mesh and the textures of its materials, are gathered once.
+ */
+class ORIONIX_API FTunnelStreamingPrefetch
+{
+	/**
+	 * **FUNCTION DECLARATIONS**
+	 */
+public:
+	/**
+	 * @brief			Constructor of FTunnelStreamingPrefetch class
+	 */
+	FTunnelStreamingPrefetch();
+
+	/**
+	 * @brief			Forgets the gathered assets and resets the counters.
+	 * @param meshCount		Number of mesh types, indexed by ABlock::meshIndex.
+	 */
+	void initialize(int32 meshCount);
+
+	/**
+	 * @brief			Forces every LOD and mip of a mesh type and its textures resident for the given time.
+	 * @param meshIndex		Mesh type of the block.
+	 * @param mesh			Static mesh of the mesh type.
+	 * @param seconds		How long the assets stay forced resident, the time until the runner reaches the block plus a margin.
+	 */
+	void prefetch(int32 meshIndex, UStaticMesh *mesh, float seconds);
+
+	/**
+	 * @brief			Records a segment that just became visible and whether its assets were resident.
+	 *				An asset is not resident while fewer LODs or mips are loaded than it can have at full quality, its LOD bias
+	 *				and uninstalled optional LODs aside, whatever the streamer has requested so far.
+	 * @param meshIndex		Mesh type of the block.
+	 * @param mesh			Static mesh of the mesh type.
+	 * @return			True if every streamed asset of the block was resident.
+	 */
+	bool recordShown(int32 meshIndex, UStaticMesh *mesh);
+
+	/**
+	 * @brief			Returns the number of segments shown with non-resident LODs or mips
+	 * @return			Segments counted by recordShown since initialize
+	 */
+	int64 getNonResidentShownCount() const;
+
+	/**
+	 * @brief			Logs the prefetch hints issued and the segments shown with and without resident assets.
+	 */
+	void logStatus() const;
+
+private:
+	/**
+	 * @brief			Returns the streamed assets of a mesh type, gathered on the first call.
+	 * @param meshIndex		Mesh type of the block.
+	 * @param mesh			Static mesh of the mesh type.
+	 * @return			The mesh followed by the textures its materials use
+	 */
+	const TArray<TWeakObjectPtr<UStreamableRenderAsset>> &getStreamingAssets(int32 meshIndex, UStaticMesh *mesh);
+
+	/**
+	 * **VARIABLE DECLARATIONS**
+	 */
+private:
+	struct FMeshStreamingAssets
+	{
+		bool bGathered = false;								// Whether assets has been filled
+		TArray<TWeakObjectPtr<UStreamableRenderAsset>> assets;				// The mesh followed by the textures its materials use
+	};
+	TArray<FMeshStreamingAssets> meshAssets;						// Streamed assets of every mesh type, indexed by ABlock::meshIndex
+	TArray<TWeakObjectPtr<UStreamableRenderAsset>> noAssets;				// Returned for an unknown mesh type
+
+	int64 prefetchCount;									// Prefetch hints issued
+	int64 shownCount;									// Segments that became visible
+	int64 nonResidentShownCount;								// Segments that became visible with non-resident LODs or mips
+};
@@ -9,5 +9,10 @@ public class Orionix : ModuleRules
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 
 		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "EnhancedInput" });
+
+		if (Target.bBuildEditor)
+		{
+			PrivateDependencyModuleNames.Add("TraceAnalysis");		// OrionixTraceAnalyzer commandlet
+		}
 	}
 }
@@ -1,7 +1,21 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "Orionix.h"
+#include "FTunnelSoakBenchmark.h"
 #include "Modules/ModuleManager.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, Orionix, "Orionix" );
- 
\ No newline at end of file
+CSV_DEFINE_CATEGORY(Orionix, true);
+
+/**
+ * @brief			Game module of Orionix. A soak run installs its allocation counter here, while the engine is still loading.
+ */
+class FOrionixGameModule: public FDefaultGameModuleImpl
+{
+public:
+	virtual void StartupModule() override
+	{
+		FTunnelSoakBenchmark::installAllocationCounter();
+	}
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FOrionixGameModule, Orionix, "Orionix" );
@@ -3,3 +3,8 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+DECLARE_STATS_GROUP(TEXT("Orionix"), STATGROUP_Orionix, STATCAT_Advanced);		// stat Orionix: tunnel and block pool hot paths
+CSV_DECLARE_CATEGORY_EXTERN(Orionix);							// -csvprofile: the same data as CSV stats
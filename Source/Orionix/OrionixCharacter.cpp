@@ -11,6 +11,7 @@
 #include "EnhancedInputSubsystems.h"
 #include "InputActionValue.h"
 #include "OrionixGameMode.h"
+#include "RunnerMovementComponent.h"
 #include <Kismet/GameplayStatics.h>
 
 DEFINE_LOG_CATEGORY(LogTemplateCharacter);
@@ -18,7 +19,8 @@ DEFINE_LOG_CATEGORY(LogTemplateCharacter);
 //////////////////////////////////////////////////////////////////////////
 // AOrionixCharacter
 
-AOrionixCharacter::AOrionixCharacter()
+AOrionixCharacter::AOrionixCharacter(const FObjectInitializer &ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<URunnerMovementComponent>(ACharacter::CharacterMovementComponentName))	// Resolves the tunnel floor without sweeping while walking
 {
 	// Set size for collision capsule
 	GetCapsuleComponent()->InitCapsuleSize(42.f, 96.0f);
@@ -56,10 +58,9 @@ AOrionixCharacter::AOrionixCharacter()
 	// are set in the derived blueprint asset named ThirdPersonCharacter (to avoid direct content references in C++)
 }
 
-void AOrionixCharacter::Tick(float DeltaTime)
+void AOrionixCharacter::stepSpeed(float StepSeconds)
 {
-	//AddMovementInput(StartMovementDirection, 1.0f);
-	currentSpeed += acceleration * DeltaTime;
+	currentSpeed += acceleration * StepSeconds;
 	if(currentSpeed > maxSpeed)
 	{
 		currentSpeed = maxSpeed;
@@ -152,20 +153,26 @@ void AOrionixCharacter::Look(const FInputActionValue& Value)
 
 void AOrionixCharacter::LeftClick()
 {
-	AOrionixGameMode *gameMode = Cast<AOrionixGameMode>(UGameplayStatics::GetGameMode(GetWorld()));
-
-	if(gameMode && gameMode->TunnelManager)
+	if(ATunnelManager *manager = GetTunnelManager())
 	{
-		gameMode->TunnelManager->turnLeft();
+		manager->handleTurnInput(ETunnelTurn::Left);
 	}
 }
 
 void AOrionixCharacter::RightClick()
 {
-	AOrionixGameMode *gameMode = Cast<AOrionixGameMode>(UGameplayStatics::GetGameMode(GetWorld()));
+	if(ATunnelManager *manager = GetTunnelManager())
+	{
+		manager->handleTurnInput(ETunnelTurn::Right);
+	}
+}
 
-	if(gameMode && gameMode->TunnelManager)
+ATunnelManager *AOrionixCharacter::GetTunnelManager()
+{
+	if(!tunnelManager.IsValid())
 	{
-		gameMode->TunnelManager->turnRight();
+		AOrionixGameMode *gameMode = Cast<AOrionixGameMode>(UGameplayStatics::GetGameMode(GetWorld()));
+		tunnelManager = gameMode ? gameMode->TunnelManager : nullptr;	// The game mode may spawn it after this character's BeginPlay
 	}
+	return tunnelManager.Get();
 }
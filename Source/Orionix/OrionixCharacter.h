@@ -8,6 +8,7 @@
 #include "OrionixCharacter.generated.h"
 
 class USpringArmComponent;
+class ATunnelManager;
 class UCameraComponent;
 class UInputMappingContext;
 class UInputAction;
@@ -52,8 +53,10 @@ class AOrionixCharacter: public ACharacter
 	UInputAction *RightClickAction;
 
 public:
-	AOrionixCharacter();
-	virtual void Tick(float DeltaTime) override;
+	AOrionixCharacter(const FObjectInitializer &ObjectInitializer);
+
+	/** Ramps the walk speed up by one tunnel simulation step, called by ATunnelManager so the ramp shares its clock */
+	void stepSpeed(float StepSeconds);
 protected:
 
 	/** Called for movement input */
@@ -64,6 +67,9 @@ protected:
 	void LeftClick();
 	void RightClick();
 
+	/** Returns the tunnel manager of the game mode, looked up on the first call that finds it */
+	ATunnelManager *GetTunnelManager();
+
 protected:
 	// APawn interface
 	virtual void SetupPlayerInputComponent(class UInputComponent *PlayerInputComponent) override;
@@ -89,5 +95,6 @@ private:
 	float maxSpeed = 1500.0f;
 	float currentSpeed = 500.0f;
 	FVector StartMovementDirection;
+	TWeakObjectPtr<ATunnelManager> tunnelManager;	// Receives the turn inputs, resolved once
 };
 
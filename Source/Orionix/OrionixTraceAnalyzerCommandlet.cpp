@@ -0,0 +1,273 @@
+#include "OrionixTraceAnalyzerCommandlet.h"
+#include "FOrionixTrace.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+
+#if WITH_EDITOR
+#include "Trace/Analysis.h"
+#include "Trace/Analyzer.h"
+#include "Trace/DataStream.h"
+
+/**
+ * @brief			Collects the Orionix events of a trace in the order they were emitted.
+ */
+class FOrionixTraceAnalyzer: public UE::Trace::IAnalyzer
+{
+public:
+	struct FFrameSample { uint64 cycle; };
+	struct FBlockSample { uint64 cycle; int64 segmentNumber; uint32 blockId; uint8 kind; };
+	struct FTurnSample { uint64 cycle; uint8 kind; };
+
+	enum : uint16
+	{
+		RouteId_Session,
+		RouteId_Frame,
+		RouteId_Block,
+		RouteId_Turn
+	};
+
+	virtual void OnAnalysisBegin(const FOnAnalysisContext &Context) override
+	{
+		FInterfaceBuilder &Builder = Context.InterfaceBuilder;
+		Builder.RouteEvent(RouteId_Session, "Orionix", "Session");
+		Builder.RouteEvent(RouteId_Frame, "Orionix", "Frame");
+		Builder.RouteEvent(RouteId_Block, "Orionix", "Block");
+		Builder.RouteEvent(RouteId_Turn, "Orionix", "Turn");
+	}
+
+	virtual bool OnEvent(uint16 RouteId, EStyle Style, const FOnEventContext &Context) override
+	{
+		const FEventData &EventData = Context.EventData;
+		switch(RouteId)
+		{
+		case RouteId_Session:
+			cycleFrequency = EventData.GetValue<uint64>("CycleFrequency");
+			break;
+		case RouteId_Frame:
+			frames.Add({EventData.GetValue<uint64>("Cycle")});
+			break;
+		case RouteId_Block:
+			blocks.Add({EventData.GetValue<uint64>("Cycle"), EventData.GetValue<int64>("SegmentNumber"), EventData.GetValue<uint32>("BlockId"), EventData.GetValue<uint8>("Kind")});
+			break;
+		case RouteId_Turn:
+			turns.Add({EventData.GetValue<uint64>("Cycle"), EventData.GetValue<uint8>("Kind")});
+			break;
+		}
+		return true;
+	}
+
+	uint64 cycleFrequency = 0;							// Cycles per second of the traced session
+	TArray<FFrameSample> frames;							// Start of every tunnel frame
+	TArray<FBlockSample> blocks;							// Every block event
+	TArray<FTurnSample> turns;							// Every turn event
+};
+
+/**
+ * @brief			Nearest rank percentile of sorted samples, 0 without samples.
+ */
+static double getPercentile(const TArray<double> &sortedSamples, double percentile)
+{
+	if(sortedSamples.Num() == 0)
+	{
+		return 0.0;
+	}
+	int32 rank = FMath::CeilToInt32(percentile / 100.0 * sortedSamples.Num());
+	return sortedSamples[FMath::Clamp(rank - 1, 0, sortedSamples.Num() - 1)];
+}
+
+/**
+ * @brief			Logs a latency distribution and returns it as a JSON object.
+ */
+static FString reportLatency(const TCHAR *name, TArray<double> &latenciesMs)
+{
+	latenciesMs.Sort();
+	UE_LOG(LogTemp, Display, TEXT("%s: %d samples, p50 %.3f ms, p95 %.3f ms, p99 %.3f ms, max %.3f ms"), name, latenciesMs.Num(),
+		getPercentile(latenciesMs, 50), getPercentile(latenciesMs, 95), getPercentile(latenciesMs, 99), getPercentile(latenciesMs, 100));
+	return FString::Printf(TEXT("\t\"%s\": {\"samples\": %d, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f}"), name, latenciesMs.Num(),
+		getPercentile(latenciesMs, 50), getPercentile(latenciesMs, 95), getPercentile(latenciesMs, 99), getPercentile(latenciesMs, 100));
+}
+#endif
+
+// Constructor
+UOrionixTraceAnalyzerCommandlet::UOrionixTraceAnalyzerCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+// Public Functions
+int32 UOrionixTraceAnalyzerCommandlet::Main(const FString &Params)
+{
+#if WITH_EDITOR
+	FString tracePath;
+	if(!FParse::Value(*Params, TEXT("Trace="), tracePath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Usage: -run=OrionixTraceAnalyzer -Trace=<file.utrace> [-Report=<file.json>] [-HitchFactor=2]"));
+		return 1;
+	}
+	double hitchFactor = 2.0;
+	FParse::Value(*Params, TEXT("HitchFactor="), hitchFactor);
+
+	UE::Trace::FFileDataStream dataStream;
+	if(!dataStream.Open(*tracePath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Cannot open trace %s"), *tracePath);
+		return 1;
+	}
+
+	FOrionixTraceAnalyzer analyzer;
+	UE::Trace::FAnalysisContext context;
+	context.AddAnalyzer(analyzer);
+	context.Process(dataStream).Wait();
+
+	if(analyzer.cycleFrequency == 0 || analyzer.frames.Num() < 2)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s has no Orionix events, record it with -trace=default,Orionix"), *tracePath);
+		return 1;
+	}
+
+	const double msPerCycle = 1000.0 / analyzer.cycleFrequency;
+	analyzer.frames.Sort([](const auto &a, const auto &b) { return a.cycle < b.cycle; });
+	analyzer.blocks.StableSort([](const auto &a, const auto &b) { return a.cycle < b.cycle; });
+	analyzer.turns.StableSort([](const auto &a, const auto &b) { return a.cycle < b.cycle; });
+
+	// Recycle latency: from the trigger of a segment until its block is back in the pool
+	// Pop to visible latency: from the pool handing out a block until it is shown in the tunnel
+	TMap<int64, uint64> triggerCycles;
+	TMap<uint32, uint64> popCycles;
+	TArray<double> recycleMs;
+	TArray<double> popToShownMs;
+	for(const FOrionixTraceAnalyzer::FBlockSample &block : analyzer.blocks)
+	{
+		switch((EOrionixBlockEvent)block.kind)
+		{
+		case EOrionixBlockEvent::Popped:
+			popCycles.Add(block.blockId, block.cycle);
+			break;
+		case EOrionixBlockEvent::Shown:
+			if(const uint64 *popCycle = popCycles.Find(block.blockId))
+			{
+				popToShownMs.Add((block.cycle - *popCycle) * msPerCycle);
+				popCycles.Remove(block.blockId);
+			}
+			break;
+		case EOrionixBlockEvent::Triggered:
+			triggerCycles.Add(block.segmentNumber, block.cycle);
+			break;
+		case EOrionixBlockEvent::Returned:
+			if(const uint64 *triggerCycle = triggerCycles.Find(block.segmentNumber))
+			{
+				recycleMs.Add((block.cycle - *triggerCycle) * msPerCycle);
+				triggerCycles.Remove(block.segmentNumber);
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	// Hitches: frames longer than hitchFactor times the median frame, and how many of them handled block work
+	TArray<double> frameMs;
+	for(int32 i = 0; i + 1 < analyzer.frames.Num(); i++)
+	{
+		frameMs.Add((analyzer.frames[i + 1].cycle - analyzer.frames[i].cycle) * msPerCycle);
+	}
+	TArray<double> sortedFrameMs = frameMs;
+	sortedFrameMs.Sort();
+	double hitchMs = getPercentile(sortedFrameMs, 50) * hitchFactor;
+
+	int32 hitches = 0, hitchesWithRecycles = 0, hitchesWithPops = 0, framesWithRecycles = 0;
+	int32 blockIndex = 0;
+	for(int32 i = 0; i < frameMs.Num(); i++)
+	{
+		bool recycled = false, popped = false;
+		for(; blockIndex < analyzer.blocks.Num() && analyzer.blocks[blockIndex].cycle < analyzer.frames[i + 1].cycle; blockIndex++)
+		{
+			const FOrionixTraceAnalyzer::FBlockSample &block = analyzer.blocks[blockIndex];
+			if(block.cycle < analyzer.frames[i].cycle) continue;
+			recycled |= (EOrionixBlockEvent)block.kind == EOrionixBlockEvent::Triggered;
+			popped |= (EOrionixBlockEvent)block.kind == EOrionixBlockEvent::Popped;
+		}
+		framesWithRecycles += recycled ? 1 : 0;
+		if(frameMs[i] > hitchMs)
+		{
+			hitches++;
+			hitchesWithRecycles += recycled ? 1 : 0;
+			hitchesWithPops += popped ? 1 : 0;
+		}
+	}
+
+	// Turn latency: from the input to the first frame that renders the started turn, and the duration of the turn
+	TArray<double> inputToMotionMs;
+	TArray<double> turnDurationMs;
+	TArray<uint64> pendingInputCycles;							// Inputs waiting for their turn to start, oldest first
+	uint64 startCycle = 0;
+	int32 frameIndex = 0;
+	for(const FOrionixTraceAnalyzer::FTurnSample &turn : analyzer.turns)
+	{
+		switch((EOrionixTurnEvent)turn.kind)
+		{
+		case EOrionixTurnEvent::Input:
+			pendingInputCycles.Add(turn.cycle);					// Queued inputs start in order
+			break;
+		case EOrionixTurnEvent::Dropped:
+			if(pendingInputCycles.Num() > 0)
+			{
+				pendingInputCycles.Pop(false);					// The dropped input is the latest one
+			}
+			break;
+		case EOrionixTurnEvent::Started:
+			startCycle = turn.cycle;
+			if(pendingInputCycles.Num() > 0)
+			{
+				uint64 inputCycle = pendingInputCycles[0];
+				pendingInputCycles.RemoveAt(0, 1, false);
+				while(frameIndex < analyzer.frames.Num() && analyzer.frames[frameIndex].cycle <= turn.cycle)
+				{
+					frameIndex++;
+				}
+				if(frameIndex < analyzer.frames.Num())
+				{
+					inputToMotionMs.Add((analyzer.frames[frameIndex].cycle - inputCycle) * msPerCycle);
+				}
+			}
+			break;
+		case EOrionixTurnEvent::Ended:
+			if(startCycle > 0)
+			{
+				turnDurationMs.Add((turn.cycle - startCycle) * msPerCycle);
+				startCycle = 0;
+			}
+			break;
+		}
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Trace %s: %d frames, %d block events, %d turn events"), *tracePath, analyzer.frames.Num(), analyzer.blocks.Num(), analyzer.turns.Num());
+	TArray<FString> sections;
+	sections.Add(reportLatency(TEXT("recycle_ms"), recycleMs));
+	sections.Add(reportLatency(TEXT("pop_to_shown_ms"), popToShownMs));
+	sections.Add(reportLatency(TEXT("frame_ms"), sortedFrameMs));
+	sections.Add(reportLatency(TEXT("turn_input_to_motion_ms"), inputToMotionMs));
+	sections.Add(reportLatency(TEXT("turn_duration_ms"), turnDurationMs));
+
+	double recycleFrameShare = frameMs.Num() > 0 ? (double)framesWithRecycles / frameMs.Num() : 0.0;
+	double recycleHitchShare = hitches > 0 ? (double)hitchesWithRecycles / hitches : 0.0;
+	UE_LOG(LogTemp, Display, TEXT("Hitches over %.2f ms: %d, with a recycle: %.1f%% (%.1f%% of all frames recycle), with a pool pop: %.1f%%"),
+		hitchMs, hitches, recycleHitchShare * 100.0, recycleFrameShare * 100.0, hitches > 0 ? 100.0 * hitchesWithPops / hitches : 0.0);
+	sections.Add(FString::Printf(TEXT("\t\"hitches\": {\"threshold_ms\": %.4f, \"count\": %d, \"with_recycle\": %d, \"with_pool_pop\": %d, \"frames_with_recycle_share\": %.4f}"),
+		hitchMs, hitches, hitchesWithRecycles, hitchesWithPops, recycleFrameShare));
+
+	FString reportPath;
+	if(FParse::Value(*Params, TEXT("Report="), reportPath) && !FFileHelper::SaveStringToFile(TEXT("{\n") + FString::Join(sections, TEXT(",\n")) + TEXT("\n}\n"), *reportPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Cannot write report %s"), *reportPath);
+		return 1;
+	}
+	return 0;
+#else
+	UE_LOG(LogTemp, Error, TEXT("OrionixTraceAnalyzer needs an editor build"));
+	return 1;
+#endif
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "OrionixTraceAnalyzerCommandlet.generated.h"
+
+/**
+ * @brief			Reads the OrionixChannel events of a .utrace file and reports the tunnel timeline as numbers:
+ *				recycle latency, pool pop to visible latency, which hitches contain block work, and turn input to motion latency.
+ *				UnrealEditor-Cmd Orionix.uproject -run=OrionixTraceAnalyzer -Trace=<file.utrace> [-Report=<file.json>] [-HitchFactor=2]
+ *				Only available in editor builds, the trace analysis module is not part of the game.
+ */
+UCLASS()
+class ORIONIX_API UOrionixTraceAnalyzerCommandlet: public UCommandlet
+{
+	GENERATED_BODY()
+
+	/**
+	 * **FUNCTION DECLARATIONS**
+	 */
+public:
+	/**
+	 * @brief			Constructor of OrionixTraceAnalyzerCommandlet class
+	 */
+	UOrionixTraceAnalyzerCommandlet();
+
+	/**
+	 * @brief			Analyzes the trace given with -Trace and logs the report.
+	 * @param Params		Command line of the commandlet.
+	 * @return			0 on success, 1 if the trace cannot be read or has no Orionix events.
+	 */
+	virtual int32 Main(const FString &Params) override;
+};
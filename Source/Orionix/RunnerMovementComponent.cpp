@@ -0,0 +1,158 @@
+#include "RunnerMovementComponent.h"
+#include "Orionix.h"
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/Character.h"
+#include "Kismet/GameplayStatics.h"
+
+DECLARE_CYCLE_STAT(TEXT("Runner Floor Sweep"), STAT_OrionixRunnerFloorSweep, STATGROUP_Orionix);
+DECLARE_CYCLE_STAT(TEXT("Runner Analytic Floor"), STAT_OrionixRunnerAnalyticFloor, STATGROUP_Orionix);
+
+static TAutoConsoleVariable<bool> CVarRunnerAnalyticFloor(
+	TEXT("orionix.Runner.AnalyticFloor"),
+	true,
+	TEXT("Resolves the floor of the walking runner from the tunnel floor plane instead of sweeping the capsule down every frame.\n")
+	TEXT("0 uses the full floor sweep of the character movement component."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarRunnerFloorSweepInterval(
+	TEXT("orionix.Runner.FloorSweepInterval"),
+	30,
+	TEXT("Analytic floors resolved before one full floor sweep re-validates the tunnel floor plane, so holes and ledges are still found.\n")
+	TEXT("0 never re-validates while the tunnel is stable."),
+	ECVF_Default);
+
+static FAutoConsoleCommandWithWorldAndArgs BenchmarkRunnerFloorCommand(
+	TEXT("orionix.Runner.BenchmarkFloor"),
+	TEXT("Times the full floor sweep of the character movement component against the analytic tunnel floor at the runner location.\n")
+	TEXT("Usage: orionix.Runner.BenchmarkFloor [Iterations=10000]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString> &Args, UWorld *World)
+	{
+		ACharacter *runner = Cast<ACharacter>(UGameplayStatics::GetPlayerPawn(World, 0));
+		URunnerMovementComponent *runnerMovement = runner ? Cast<URunnerMovementComponent>(runner->GetCharacterMovement()) : nullptr;
+		if(!runnerMovement)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("No runner with a URunnerMovementComponent"));
+			return;
+		}
+		runnerMovement->benchmarkFloor(Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 10000);
+	}));
+
+// Public Functions
+void URunnerMovementComponent::FindFloor(const FVector &CapsuleLocation, FFindFloorResult &OutFloorResult, bool bCanUseCachedLocation, const FHitResult *DownwardSweepResult) const
+{
+	if(findAnalyticFloor(CapsuleLocation, OutFloorResult))
+	{
+		return;
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_OrionixRunnerFloorSweep);
+		Super::FindFloor(CapsuleLocation, OutFloorResult, bCanUseCachedLocation, DownwardSweepResult);
+	}
+
+	// Only a flat floor found while walking on a tunnel at rest is the floor plane of the tunnel
+	const FHitResult &floorHit = OutFloorResult.HitResult;
+	floorCalibrated = tunnelStable && tunnelSolidFloor && IsMovingOnGround() && OutFloorResult.IsWalkableFloor() && floorHit.ImpactNormal.Z > 0.999f;
+	if(floorCalibrated)
+	{
+		floorPlane = FPlane(floorHit.ImpactPoint, floorHit.ImpactNormal);
+	}
+	analyticFloorCount = 0;
+}
+
+void URunnerMovementComponent::setTunnelFloor(bool bStable, bool bSolidFloor, int64 floorSegment, UPrimitiveComponent *floorComponent)
+{
+	if(!bStable || floorSegment != tunnelFloorSegment)
+	{
+		floorCalibrated = false;								// The floor tilts while the tunnel turns, a new block is swept once
+	}
+	tunnelStable = bStable;
+	tunnelSolidFloor = bSolidFloor;
+	tunnelFloorSegment = floorSegment;
+	tunnelFloorComponent = floorComponent;
+}
+
+void URunnerMovementComponent::benchmarkFloor(int32 iterations)
+{
+	if(!UpdatedComponent)
+	{
+		return;
+	}
+
+	FVector location = UpdatedComponent->GetComponentLocation();
+	FFindFloorResult floorResult;
+	uint64 startCycles = FPlatformTime::Cycles64();
+	for(int32 i = 0; i < iterations; i++)
+	{
+		Super::FindFloor(location, floorResult, false);					// What every walking frame cost before
+	}
+	double sweepSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - startCycles);
+
+	bool analyticAvailable = true;
+	int32 savedAnalyticFloorCount = analyticFloorCount;
+	startCycles = FPlatformTime::Cycles64();
+	for(int32 i = 0; i < iterations && analyticAvailable; i++)
+	{
+		analyticFloorCount = 0;								// Measures the analytic path only
+		analyticAvailable = findAnalyticFloor(location, floorResult);
+	}
+	double analyticSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - startCycles);
+	analyticFloorCount = savedAnalyticFloorCount;
+
+	if(!analyticAvailable)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Floor sweep: %.1f ns per floor, analytic floor not available (airborne, turning, floor with gaps, disabled or not calibrated yet)"), sweepSeconds * 1e9 / iterations);
+		return;
+	}
+	UE_LOG(LogTemp, Warning, TEXT("Iterations: %d, Floor sweep: %.1f ns per floor, Analytic floor: %.1f ns per floor, Floor distance: %.2f"),
+		iterations, sweepSeconds * 1e9 / iterations, analyticSeconds * 1e9 / iterations, floorResult.FloorDist);
+}
+
+// Protected Functions
+void URunnerMovementComponent::OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode)
+{
+	Super::OnMovementModeChanged(PreviousMovementMode, PreviousCustomMode);
+	if(!IsMovingOnGround())
+	{
+		floorCalibrated = false;
+	}
+}
+
+// Private Functions
+bool URunnerMovementComponent::findAnalyticFloor(const FVector &CapsuleLocation, FFindFloorResult &OutFloorResult) const
+{
+	if(!floorCalibrated || !tunnelStable || !tunnelSolidFloor || !IsMovingOnGround() || !CharacterOwner || !CVarRunnerAnalyticFloor.GetValueOnGameThread())
+	{
+		return false;
+	}
+	int32 sweepInterval = CVarRunnerFloorSweepInterval.GetValueOnGameThread();
+	if(sweepInterval > 0 && analyticFloorCount >= sweepInterval)
+	{
+		return false;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_OrionixRunnerAnalyticFloor);
+	FVector floorNormal = floorPlane.GetNormal();
+	FVector capsuleBottom = CapsuleLocation - FVector::UpVector * CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+	float floorDistance = floorPlane.PlaneDot(capsuleBottom);
+	if(floorDistance < 0.0f || floorDistance > MAX_FLOOR_DIST)
+	{
+		return false;									// Off the plane, e.g. stepping off a ledge, the sweep decides
+	}
+
+	UPrimitiveComponent *floorComponent = tunnelFloorComponent.Get();
+	FHitResult floorHit(1.0f);
+	floorHit.bBlockingHit = true;
+	floorHit.TraceStart = CapsuleLocation;
+	floorHit.TraceEnd = CapsuleLocation - floorNormal * floorDistance;
+	floorHit.Location = floorHit.TraceEnd;
+	floorHit.ImpactPoint = capsuleBottom - floorNormal * floorDistance;
+	floorHit.Normal = floorNormal;
+	floorHit.ImpactNormal = floorNormal;
+	floorHit.Distance = floorDistance;
+	floorHit.Component = floorComponent;
+	floorHit.HitObjectHandle = FActorInstanceHandle(floorComponent ? floorComponent->GetOwner() : nullptr);
+	OutFloorResult.SetFromSweep(floorHit, floorDistance, true);
+	analyticFloorCount++;
+	return true;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "RunnerMovementComponent.generated.h"
+
+/**
+ * @brief			Character movement of the runner. Walking on the tunnel floor resolves the floor analytically instead of
+ *				sweeping the capsule down every frame: the tunnel cross-section only rolls in quarter turns around its axis, so
+ *				while no turn is in progress the floor under the runner is the same plane whatever block it stands on.
+ *				The plane is calibrated by one full floor sweep, again on every new block, and re-validated every
+ *				orionix.Runner.FloorSweepInterval floors. Only blocks whose collision FBlockPool measured as a flat floor use the
+ *				plane, a block with holes, gaps or ledges is always swept. Full sweeps are also used while airborne, while the
+ *				tunnel turns and whenever the runner is not close to the plane.
+ *				ATunnelManager reports the tunnel state every simulation step through setTunnelFloor.
+ */
+UCLASS()
+class ORIONIX_API URunnerMovementComponent: public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+	/**
+	 * **FUNCTION DECLARATIONS**
+	 */
+public:
+	/**
+	 * @brief			Finds the floor under the capsule. Uses the calibrated tunnel floor plane while walking on a stable tunnel,
+	 *				else the full sweep of UCharacterMovementComponent, which calibrates the plane when it finds a walkable floor.
+	 */
+	virtual void FindFloor(const FVector &CapsuleLocation, FFindFloorResult &OutFloorResult, bool bCanUseCachedLocation, const FHitResult *DownwardSweepResult = nullptr) const override;
+
+	/**
+	 * @brief			Reports the state of the tunnel, called by ATunnelManager every simulation step.
+	 * @param bStable		Whether the tunnel cross-section is at rest, false while a turn is in progress.
+	 * @param bSolidFloor		Whether the block the runner stands on and the next one have no holes or gaps in their floor.
+	 * @param floorSegment		Segment number of the block the runner stands on, a new block calibrates the plane again.
+	 * @param floorComponent	Component of the block the runner stands on, used as the movement base of the analytic floor.
+	 */
+	void setTunnelFloor(bool bStable, bool bSolidFloor, int64 floorSegment, UPrimitiveComponent *floorComponent);
+
+	/**
+	 * @brief			Times the full floor sweep against the analytic floor at the current location and logs both.
+	 *				Used by orionix.Runner.BenchmarkFloor.
+	 * @param iterations		Number of floor queries timed with each method.
+	 */
+	void benchmarkFloor(int32 iterations);
+
+protected:
+	/**
+	 * @brief			Forgets the floor plane when the runner stops walking, it is calibrated again after landing.
+	 */
+	virtual void OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode) override;
+
+private:
+	/**
+	 * @brief			Resolves the floor from the calibrated plane.
+	 * @param CapsuleLocation	Location of the capsule center.
+	 * @param OutFloorResult	Filled with the floor when the runner is within reach of the plane.
+	 * @return			False if the plane cannot be used and a full sweep is needed.
+	 */
+	bool findAnalyticFloor(const FVector &CapsuleLocation, FFindFloorResult &OutFloorResult) const;
+
+	/**
+	 * **VARIABLE DECLARATIONS**
+	 */
+private:
+	bool tunnelStable = false;								// Whether the tunnel cross-section is at rest
+	bool tunnelSolidFloor = false;								// Whether the floor under the runner has no holes or gaps
+	int64 tunnelFloorSegment = INDEX_NONE;						// Segment number of the block the runner stands on
+	TWeakObjectPtr<UPrimitiveComponent> tunnelFloorComponent;				// Block the runner stands on, reported by ATunnelManager
+
+	mutable bool floorCalibrated = false;							// Whether floorPlane comes from a full sweep on the current block since the tunnel was last unstable
+	mutable FPlane floorPlane = FPlane(FVector::UpVector, 0.0f);				// World floor plane of the tunnel, normal pointing up
+	mutable int32 analyticFloorCount = 0;							// Analytic floors resolved since the last full sweep
+};
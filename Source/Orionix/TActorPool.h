@@ -0,0 +1,525 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "TWeightedPool.h"
+
+/**
+ * @brief			Population policy of a TActorPool.
+ */
+struct FActorPoolSettings
+{
+	int32 prewarmCountPerType = 1;				// Actors spawned for every type when the pool is initialized
+	int32 synchronousPrewarmCount = INDEX_NONE;		// Prewarm actors spawned by initialize, the rest is spawned by tick. INDEX_NONE spawns all of them
+	double prewarmBudgetMs = 2.0;				// Time the pool may spend spawning prewarm actors per frame
+	int32 growthBatchSize = 4;				// Actors queued for spawning each time the pool needs to grow
+	float highWaterFraction = 0.8f;				// The pool grows once more than this fraction of its actors is in use
+	double growthBudgetMs = 1.0;				// Time the pool may spend spawning queued actors per frame
+	double shrinkAfterIdleSeconds = 30.0;			// Actors above the prewarm count are destroyed after this long under the high-water mark, 0 never shrinks
+	int64 memoryBudgetBytes = 0;				// The pool does not grow beyond this estimated size, 0 is unlimited
+	bool spawnOnMiss = true;				// A request that finds no free actor spawns one immediately instead of failing
+};
+
+/**
+ * @brief			Runtime counters of a TActorPool.
+ */
+struct FActorPoolCounters
+{
+	int64 acquisitions = 0;					// Actors handed out
+	int64 misses = 0;					// Requests that found no free actor
+	int64 spawned = 0;					// Actors spawned by the pool
+	int64 destroyed = 0;					// Actors destroyed by shrinking
+	int32 inUse = 0;					// Actors currently handed out
+	int32 peakInUse = 0;					// Highest number of actors handed out at the same time
+	double totalSpawnTime = 0.0;				// Time spent spawning actors, in seconds
+	double maxSpawnTime = 0.0;				// Most expensive spawn, in seconds
+	int64 estimatedActorBytes = 0;				// Estimated size of one pooled actor and its components
+};
+
+/**
+ * @brief			Pool of pre-spawned actors grouped by type, handed out by weight in O(1).
+ *				The pool grows in time slices when it runs hot, shrinks back after being idle, and respects a memory budget.
+ *				A single-type pool (obstacles, pickups) uses one type with any positive weight.
+ */
+template<typename ActorType>
+class TActorPool
+{
+	/**
+	 * **FUNCTION DECLARATIONS**
+	 */
+public:
+	/**
+	 * @brief			Called for every actor the pool spawns. Returns whether the actor can be handed out right away;
+	 *				an actor that is not ready is kept out of the pool until markReady is called for it.
+	 */
+	using FSpawnedCallback = TFunction<bool(ActorType *actor, int32 type)>;
+
+	/**
+	 * @brief			Called right before the pool destroys one of its actors.
+	 */
+	using FDestroyingCallback = TFunction<void(ActorType *actor)>;
+
+	/**
+	 * @brief			Initializes the pool and spawns the prewarm actors of every type.
+	 *				Only **synchronousPrewarmCount** actors are spawned right away, type by type in order;
+	 *				the rest of the prewarm population is spawned by tick within **prewarmBudgetMs** per frame.
+	 * @param World			The game world context where the actors will be spawned.
+	 * @param ActorClass		The subclass of ActorType to be spawned.
+	 * @param typeWeights		Selection weight of every type, see TWeightedPool.
+	 * @param poolSettings		Population policy of the pool.
+	 * @param onSpawned		Called for every spawned actor.
+	 */
+	void initialize(UWorld *World, TSubclassOf<ActorType> ActorClass, const TArray<float> &typeWeights, const FActorPoolSettings &poolSettings, FSpawnedCallback onSpawned)
+	{
+		worldContext = World;
+		actorClass = ActorClass;
+		settings = poolSettings;
+		spawnedCallback = MoveTemp(onSpawned);
+		freeActors.initialize(typeWeights);
+		lastBusyTime = FPlatformTime::Seconds();
+
+		prewarmQueue.Reset();
+		prewarmCursor = 0;
+		for(int32 i = 0; i < settings.prewarmCountPerType; i++)
+		{
+			for(int32 type = 0; type < typeWeights.Num(); type++)
+			{
+				prewarmQueue.Add(type);						// Every type once before any type twice
+			}
+		}
+		prewarmCount = prewarmQueue.Num();
+
+		int32 synchronousCount = settings.synchronousPrewarmCount == INDEX_NONE ? prewarmQueue.Num() : FMath::Min(settings.synchronousPrewarmCount, prewarmQueue.Num());
+		while(prewarmCursor < synchronousCount)
+		{
+			spawnActor(prewarmQueue[prewarmCursor++], false);
+		}
+	}
+
+	/**
+	 * @brief			Hands out an actor of a weighted random type in O(1).
+	 * @return			The actor, or nullptr if no actor is free and none could be spawned.
+	 */
+	ActorType *acquire()
+	{
+		ActorType *actor = nullptr;
+		if(!freeActors.popWeighted(actor))
+		{
+			actor = handleMiss(freeActors.sampleType());
+		}
+		return onAcquired(actor);
+	}
+
+	/**
+	 * @brief			Hands out an actor of the given type in O(1).
+	 * @param type			Type of the actor.
+	 * @return			The actor, or nullptr if no actor of the type is free and none could be spawned.
+	 */
+	ActorType *acquireType(int32 type)
+	{
+		ActorType *actor = nullptr;
+		if(!freeActors.popType(type, actor))
+		{
+			actor = handleMiss(type);
+		}
+		return onAcquired(actor);
+	}
+
+	/**
+	 * @brief			Returns a handed out actor to the pool in O(1).
+	 * @param actor			The actor to be returned.
+	 * @param type			Type the actor was spawned with.
+	 */
+	void release(ActorType *actor, int32 type = 0)
+	{
+		if(actor)
+		{
+			freeActors.add(type, actor);
+			counters.inUse--;
+		}
+	}
+
+	/**
+	 * @brief			Makes an actor that was not ready when it was spawned available.
+	 * @param actor			The actor to be made available.
+	 * @param type			Type the actor was spawned with.
+	 */
+	void markReady(ActorType *actor, int32 type = 0)
+	{
+		if(actor)
+		{
+			freeActors.add(type, actor);
+		}
+	}
+
+	/**
+	 * @brief			Spawns queued actors within the per-frame budget, and destroys surplus actors once the pool has been idle.
+	 *				Must be called once per frame by the owner of the pool.
+	 */
+	void tick()
+	{
+		if(!isPrewarmComplete())
+		{
+			double prewarmDeadline = FPlatformTime::Seconds() + settings.prewarmBudgetMs / 1000.0;
+			while(prewarmCursor < prewarmQueue.Num())
+			{
+				spawnActor(prewarmQueue[prewarmCursor++], false);
+				if(FPlatformTime::Seconds() >= prewarmDeadline) break;		// At least one actor per frame, whatever the budget
+			}
+			return;									// No growth or shrink before the pool is complete
+		}
+
+		double now = FPlatformTime::Seconds();
+		double deadline = now + settings.growthBudgetMs / 1000.0;
+		while(pendingGrowth.Num() > 0)
+		{
+			spawnActor(pendingGrowth.Pop(false), false);
+			if(FPlatformTime::Seconds() >= deadline) break;			// At least one actor per frame, whatever the budget
+		}
+
+		bool bIdle = settings.shrinkAfterIdleSeconds > 0.0 && now - lastBusyTime > settings.shrinkAfterIdleSeconds;
+		if(bIdle && pendingGrowth.Num() == 0 && pooledActors.Num() > prewarmCount)
+		{
+			destroyFreeActor();							// One actor per frame
+		}
+	}
+
+	/**
+	 * @brief			Returns whether every prewarm actor has been spawned
+	 * @return			True once the time-sliced prewarm is over
+	 */
+	bool isPrewarmComplete() const
+	{
+		return prewarmCursor >= prewarmQueue.Num();
+	}
+
+	/**
+	 * @brief			Destroys every actor the pool spawned, including the ones handed out.
+	 */
+	void destroyAll()
+	{
+		for(ActorType *actor : pooledActors)
+		{
+			if(IsValid(actor))
+			{
+				if(destroyingCallback)
+				{
+					destroyingCallback(actor);
+				}
+				actor->Destroy();
+			}
+		}
+		pooledActors.Reset();
+		pendingGrowth.Reset();
+		prewarmCursor = prewarmQueue.Num();
+	}
+
+	/**
+	 * @brief			Sets the callback run before the pool destroys an actor, by shrinking or by destroyAll.
+	 * @param onDestroying		Called with the actor about to be destroyed.
+	 */
+	void setDestroyingCallback(FDestroyingCallback onDestroying)
+	{
+		destroyingCallback = MoveTemp(onDestroying);
+	}
+
+	/**
+	 * @brief			Reports every spawned actor to the garbage collector, so the pool owns its actors like a UPROPERTY would.
+	 *				Called from the AddReferencedObjects of the object that owns the pool.
+	 * @param Collector		Reference collector of the running garbage collection.
+	 */
+	void addReferencedObjects(FReferenceCollector &Collector)
+	{
+		Collector.AddReferencedObjects(pooledActors);
+	}
+
+	/**
+	 * @brief			Spawns free actors of weighted random types right away, within the memory budget.
+	 *				They are destroyed again by shrinking once the pool has been idle, like grown actors.
+	 * @param count			Number of actors to spawn.
+	 * @return			Number of actors spawned.
+	 */
+	int32 spawnFree(int32 count)
+	{
+		int32 previousCount = pooledActors.Num();
+		for(int32 i = 0; i < count; i++)
+		{
+			int32 actorCount = pooledActors.Num();
+			spawnActor(freeActors.sampleType(), false);
+			if(pooledActors.Num() == actorCount)
+			{
+				break;								// Over the memory budget or the spawn failed
+			}
+		}
+		return pooledActors.Num() - previousCount;
+	}
+
+	/**
+	 * @brief			Returns every actor spawned by the pool and still alive
+	 * @return			Free, in use and not ready actors
+	 */
+	const TArray<ActorType *> &getActors() const
+	{
+		return pooledActors;
+	}
+
+	/**
+	 * @brief			Returns a spawned actor by index, whether it is free, in use or not ready
+	 * @param index			Index of the actor
+	 * @return			The actor, or nullptr for an invalid index
+	 */
+	ActorType *getActor(int32 index) const
+	{
+		return pooledActors.IsValidIndex(index) ? pooledActors[index] : nullptr;
+	}
+
+	/**
+	 * @brief			Returns the number of actors spawned by the pool and still alive
+	 * @return			Number of actors
+	 */
+	int32 getTotalCount() const
+	{
+		return pooledActors.Num();
+	}
+
+	/**
+	 * @brief			Returns the number of actors that can be handed out right away
+	 * @return			Number of free actors
+	 */
+	int32 getFreeCount() const
+	{
+		return freeActors.num();
+	}
+
+	/**
+	 * @brief			Returns the number of actors of a type that can be handed out right away
+	 * @param type			Type of the actors
+	 * @return			Number of free actors of the type
+	 */
+	int32 getFreeCountOfType(int32 type) const
+	{
+		return freeActors.numOfType(type);
+	}
+
+	/**
+	 * @brief			Returns the number of types of the pool
+	 * @return			Number of types
+	 */
+	int32 getTypeCount() const
+	{
+		return freeActors.getTypeCount();
+	}
+
+	/**
+	 * @brief			Returns the runtime counters of the pool
+	 * @return			Misses, peak usage, spawn cost, etc.
+	 */
+	const FActorPoolCounters &getCounters() const
+	{
+		return counters;
+	}
+
+	/**
+	 * @brief			Returns the estimated memory used by the actors of the pool
+	 * @return			Estimated size in bytes
+	 */
+	int64 getEstimatedMemory() const
+	{
+		return counters.estimatedActorBytes * pooledActors.Num();
+	}
+
+	/**
+	 * @brief			Makes the weighted picks and the types of grown actors come from the given stream.
+	 * @param randomStream		Stream owned by the caller that outlives the pool, or nullptr for the global random generator.
+	 */
+	void setRandomStream(const FRandomStream *randomStream)
+	{
+		freeActors.setRandomStream(randomStream);
+	}
+
+	/**
+	 * @brief			Prints the counters of the pool
+	 * @param poolName		Name printed with the counters
+	 */
+	void logStatus(const TCHAR *poolName) const
+	{
+		double averageSpawnTime = counters.spawned > 0 ? counters.totalSpawnTime / counters.spawned : 0.0;
+		UE_LOG(LogTemp, Warning, TEXT("%s: Total: %d, Free: %d, In Use: %d, Peak: %d, Misses: %lld, Spawned: %lld, Destroyed: %lld, Queued: %d"),
+			poolName, pooledActors.Num(), freeActors.num(), counters.inUse, counters.peakInUse, counters.misses, counters.spawned, counters.destroyed, pendingGrowth.Num());
+		UE_LOG(LogTemp, Warning, TEXT("%s: Spawn Cost Average: %.3f ms, Max: %.3f ms, Estimated Memory: %lld / %lld bytes"),
+			poolName, averageSpawnTime * 1000.0, counters.maxSpawnTime * 1000.0, getEstimatedMemory(), settings.memoryBudgetBytes);
+	}
+
+private:
+	/**
+	 * @brief			Spawns one actor of a type, unless it would exceed the memory budget.
+	 * @param type			Type of the actor.
+	 * @param bForImmediateUse	Whether the actor is returned to the caller instead of being added to the free actors.
+	 * @return			The actor if it is ready and bForImmediateUse is set, otherwise nullptr.
+	 */
+	ActorType *spawnActor(int32 type, bool bForImmediateUse)
+	{
+		if(!worldContext || type == INDEX_NONE || !isWithinBudget())
+		{
+			return nullptr;
+		}
+
+		double startTime = FPlatformTime::Seconds();
+		ActorType *actor = worldContext->SpawnActor<ActorType>(actorClass, FVector::ZeroVector, FRotator::ZeroRotator);
+		if(!actor)
+		{
+			return nullptr;
+		}
+		pooledActors.Add(actor);
+		bool bReady = spawnedCallback ? spawnedCallback(actor, type) : true;
+
+		double spawnTime = FPlatformTime::Seconds() - startTime;
+		counters.spawned++;
+		counters.totalSpawnTime += spawnTime;
+		counters.maxSpawnTime = FMath::Max(counters.maxSpawnTime, spawnTime);
+		if(counters.estimatedActorBytes == 0)
+		{
+			counters.estimatedActorBytes = estimateActorBytes(actor);
+		}
+
+		if(bReady && bForImmediateUse)
+		{
+			return actor;
+		}
+		if(bReady)
+		{
+			freeActors.add(type, actor);
+		}
+		return nullptr;
+	}
+
+	/**
+	 * @brief			Counts a miss, queues growth and spawns an actor right away if the policy allows it.
+	 * @param type			Type that was requested.
+	 * @return			The spawned actor, or nullptr.
+	 */
+	ActorType *handleMiss(int32 type)
+	{
+		counters.misses++;
+		queueGrowth(type);
+		return settings.spawnOnMiss ? spawnActor(type, true) : nullptr;
+	}
+
+	/**
+	 * @brief			Updates the counters for a handed out actor and queues growth above the high-water mark.
+	 * @param actor			The handed out actor, or nullptr.
+	 * @return			The same actor.
+	 */
+	ActorType *onAcquired(ActorType *actor)
+	{
+		if(actor)
+		{
+			counters.acquisitions++;
+			counters.inUse++;
+			counters.peakInUse = FMath::Max(counters.peakInUse, counters.inUse);
+			if(counters.inUse > settings.highWaterFraction * pooledActors.Num())
+			{
+				lastBusyTime = FPlatformTime::Seconds();
+				queueGrowth();
+			}
+		}
+		return actor;
+	}
+
+	/**
+	 * @brief			Queues **growthBatchSize** actors of weighted random types, unless growth is already queued.
+	 * @param requiredType		Type that was requested and missed, queued to be spawned first if it is not queued yet.
+	 */
+	void queueGrowth(int32 requiredType = INDEX_NONE)
+	{
+		if(!isPrewarmComplete())
+		{
+			return;									// The prewarm population is still arriving
+		}
+		if(pendingGrowth.Num() == 0)
+		{
+			for(int32 i = 0; i < settings.growthBatchSize; i++)
+			{
+				int32 type = freeActors.sampleType();
+				if(type != INDEX_NONE)
+				{
+					pendingGrowth.Add(type);
+				}
+			}
+		}
+		if(requiredType != INDEX_NONE && !pendingGrowth.Contains(requiredType))
+		{
+			pendingGrowth.Add(requiredType);					// tick spawns from the end of the queue
+		}
+	}
+
+	/**
+	 * @brief			Destroys one free actor of the type with the most free actors.
+	 */
+	void destroyFreeActor()
+	{
+		int32 largestType = INDEX_NONE;
+		for(int32 type = 0; type < freeActors.getTypeCount(); type++)
+		{
+			if(freeActors.numOfType(type) > 1 && (largestType == INDEX_NONE || freeActors.numOfType(type) > freeActors.numOfType(largestType)))
+			{
+				largestType = type;						// Keeps the last free actor of every type
+			}
+		}
+
+		ActorType *actor = nullptr;
+		if(largestType != INDEX_NONE && freeActors.popType(largestType, actor))
+		{
+			pooledActors.RemoveSingleSwap(actor, false);
+			if(destroyingCallback)
+			{
+				destroyingCallback(actor);
+			}
+			actor->Destroy();
+			counters.destroyed++;
+		}
+	}
+
+	/**
+	 * @brief			Returns whether one more actor fits in the memory budget.
+	 * @return			True if the budget is unlimited or not reached yet.
+	 */
+	bool isWithinBudget() const
+	{
+		return settings.memoryBudgetBytes <= 0 || getEstimatedMemory() + counters.estimatedActorBytes <= settings.memoryBudgetBytes;
+	}
+
+	/**
+	 * @brief			Estimates the size of an actor and its components from their class layouts. Shared assets are not counted.
+	 * @param actor			The actor to be measured.
+	 * @return			Estimated size in bytes
+	 */
+	static int64 estimateActorBytes(const AActor *actor)
+	{
+		int64 bytes = actor->GetClass()->GetStructureSize();
+		for(const UActorComponent *component : actor->GetComponents())
+		{
+			bytes += component ? component->GetClass()->GetStructureSize() : 0;
+		}
+		return bytes;
+	}
+
+	/**
+	 * **VARIABLE DECLARATIONS**
+	 */
+private:
+	UWorld *worldContext = nullptr;				// The game world context where actors are spawned
+	TSubclassOf<ActorType> actorClass;			// Class of the spawned actors
+	FActorPoolSettings settings;				// Population policy
+	FSpawnedCallback spawnedCallback;			// Called for every spawned actor
+	FDestroyingCallback destroyingCallback;			// Called before an actor is destroyed
+	TWeightedPool<ActorType *> freeActors;			// Actors that can be handed out, one free list per type
+	TArray<ActorType *> pooledActors;			// Every actor spawned by the pool and still alive
+	TArray<int32> pendingGrowth;				// Types of the actors queued for spawning
+	TArray<int32> prewarmQueue;				// Types of the prewarm actors, in spawn order
+	int32 prewarmCursor = 0;				// Next prewarm actor to be spawned
+	FActorPoolCounters counters;				// Runtime counters
+	int32 prewarmCount = 0;					// The pool never shrinks below the prewarmed population
+	double lastBusyTime = 0.0;				// Last time the pool was above its high-water mark
+};
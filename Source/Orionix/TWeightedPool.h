@@ -0,0 +1,190 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FAliasSampler.h"
+
+/**
+ * @brief			Pool of elements grouped by type, with one free list per type and a constant-time weighted pick between types.
+ *				Adding and removing an element never moves other elements, so both cost O(1) whatever the pool size.
+ */
+template<typename ElementType>
+class TWeightedPool
+{
+	/**
+	 * **FUNCTION DECLARATIONS**
+	 */
+public:
+	/**
+	 * @brief			Creates one empty free list per type and builds the alias table of their weights.
+	 * @param weights		Selection weight of every type. A type with a weight of zero or less is only given out by popType.
+	 */
+	void initialize(const TArray<float> &weights)
+	{
+		typeWeights = weights;
+		sampler.build(weights);
+		freeLists.Reset();
+		freeLists.SetNum(weights.Num());
+		selectableTypes.Reset();
+		selectableTypeSlots.Init(INDEX_NONE, weights.Num());
+		count = 0;
+	}
+
+	/**
+	 * @brief			Puts an element back into the free list of its type in O(1).
+	 * @param type			Type of the element.
+	 * @param element		The element to be added.
+	 */
+	void add(int32 type, const ElementType &element)
+	{
+		check(freeLists.IsValidIndex(type));
+		TArray<ElementType> &freeList = freeLists[type];
+		freeList.Push(element);
+		count++;
+
+		if(freeList.Num() == 1 && typeWeights[type] > 0.0f)
+		{
+			selectableTypeSlots[type] = selectableTypes.Add(type);
+		}
+	}
+
+	/**
+	 * @brief			Removes an element of a weighted random type in O(1).
+	 *				The alias table is built once from every type, so a pick that lands on an empty type is retried.
+	 *				After **maxRejections** misses a type is picked by weight among the non-empty types only, in O(non-empty types),
+	 *				which bounds the cost when most of the weight is in use without skewing the configured weights.
+	 * @param outElement		The removed element.
+	 * @return			False if no type with a positive weight has a free element.
+	 */
+	bool popWeighted(ElementType &outElement)
+	{
+		if(selectableTypes.Num() == 0)
+		{
+			return false;
+		}
+
+		for(int32 attempt = 0; attempt < maxRejections; attempt++)
+		{
+			int32 type = sampleType();
+			if(type != INDEX_NONE && selectableTypeSlots[type] != INDEX_NONE)
+			{
+				return popType(type, outElement);
+			}
+		}
+
+		float freeWeight = 0.0f;
+		for(int32 type : selectableTypes)
+		{
+			freeWeight += typeWeights[type];
+		}
+		float pick = (randomStream ? randomStream->GetFraction() : FMath::FRand()) * freeWeight;
+		for(int32 type : selectableTypes)
+		{
+			pick -= typeWeights[type];
+			if(pick < 0.0f)
+			{
+				return popType(type, outElement);
+			}
+		}
+		return popType(selectableTypes.Last(), outElement);				// Rounding left the pick at the very end of the prefix sum
+	}
+
+	/**
+	 * @brief			Removes an element of the given type in O(1), whatever the weight of the type.
+	 * @param type			Type of the element.
+	 * @param outElement		The removed element.
+	 * @return			False if the type has no free element.
+	 */
+	bool popType(int32 type, ElementType &outElement)
+	{
+		if(!freeLists.IsValidIndex(type) || freeLists[type].Num() == 0)
+		{
+			return false;
+		}
+
+		outElement = freeLists[type].Pop(false);
+		count--;
+
+		int32 slot = selectableTypeSlots[type];
+		if(freeLists[type].Num() == 0 && slot != INDEX_NONE)
+		{
+			int32 movedType = selectableTypes.Last();
+			selectableTypes.RemoveAtSwap(slot, 1, false);
+			if(movedType != type)
+			{
+				selectableTypeSlots[movedType] = slot;
+			}
+			selectableTypeSlots[type] = INDEX_NONE;
+		}
+		return true;
+	}
+
+	/**
+	 * @brief			Removes an element of any type with a positive weight, without weighting, in O(1).
+	 * @param outElement		The removed element.
+	 * @return			False if no type with a positive weight has a free element.
+	 */
+	bool popAny(ElementType &outElement)
+	{
+		return selectableTypes.Num() > 0 && popType(selectableTypes.Last(), outElement);
+	}
+
+	/**
+	 * @brief			Picks a weighted random type in O(1), whether it has free elements or not
+	 * @return			The picked type, or INDEX_NONE if no type has a positive weight
+	 */
+	int32 sampleType() const
+	{
+		return randomStream ? sampler.sample(*randomStream) : sampler.sample();
+	}
+
+	/**
+	 * @brief			Makes every random pick of the pool come from the given stream instead of the global random generator.
+	 * @param stream		Stream owned by the caller that outlives the pool, or nullptr for the global random generator.
+	 */
+	void setRandomStream(const FRandomStream *stream)
+	{
+		randomStream = stream;
+	}
+
+	/**
+	 * @brief			Returns the number of free elements of every type
+	 * @return			Number of free elements
+	 */
+	int32 num() const
+	{
+		return count;
+	}
+
+	/**
+	 * @brief			Returns the number of free elements of a type
+	 * @param type			Type of the elements
+	 * @return			Number of free elements of the type
+	 */
+	int32 numOfType(int32 type) const
+	{
+		return freeLists.IsValidIndex(type) ? freeLists[type].Num() : 0;
+	}
+
+	/**
+	 * @brief			Returns the number of types given to initialize
+	 * @return			Number of types
+	 */
+	int32 getTypeCount() const
+	{
+		return freeLists.Num();
+	}
+
+	/**
+	 * **VARIABLE DECLARATIONS**
+	 */
+private:
+	static constexpr int32 maxRejections = 8;		// Alias table picks tried before falling back to a weighted pick over the non-empty types
+
+	FAliasSampler sampler;					// Weighted pick between types
+	TArray<float> typeWeights;				// Selection weight of every type
+	TArray<TArray<ElementType>> freeLists;			// Free elements of every type
+	TArray<int32> selectableTypes;				// Types with a positive weight and at least one free element
+	TArray<int32> selectableTypeSlots;			// Slot of every type in selectableTypes, or INDEX_NONE
+	int32 count = 0;					// Number of free elements
+	const FRandomStream *randomStream = nullptr;		// Stream of the random picks, the global random generator if null
+};
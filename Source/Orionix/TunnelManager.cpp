@@ -1,5 +1,232 @@
 #include "TunnelManager.h"
+#include "Orionix.h"
+#include "FOrionixTrace.h"
+#include "FOrionixMemory.h"
+#include "RunnerMovementComponent.h"
+#include "OrionixCharacter.h"
 #include "TimerManager.h"
+#include "EngineUtils.h"
+#include "GameFramework/Character.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+#include "Misc/App.h"
+#include "UObject/UObjectArray.h"
+
+DECLARE_CYCLE_STAT(TEXT("Tunnel Tick"), STAT_OrionixTunnelTick, STATGROUP_Orionix);
+DECLARE_CYCLE_STAT(TEXT("Add Block To Tunnel"), STAT_OrionixAddBlockToTunnel, STATGROUP_Orionix);
+DECLARE_CYCLE_STAT(TEXT("Remove Block From Tunnel"), STAT_OrionixRemoveBlockFromTunnel, STATGROUP_Orionix);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Live Blocks"), STAT_OrionixLiveBlocks, STATGROUP_Orionix);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pooled Blocks"), STAT_OrionixPooledBlocks, STATGROUP_Orionix);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Recycles Per Second"), STAT_OrionixRecyclesPerSecond, STATGROUP_Orionix);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Rotation In Progress Time (s)"), STAT_OrionixRotationTime, STATGROUP_Orionix);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Turn Input Latency (ms)"), STAT_OrionixTurnInputLatency, STATGROUP_Orionix);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Visible Blocks"), STAT_OrionixVisibleBlocks, STATGROUP_Orionix);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Tunnel Primitives Left Visible"), STAT_OrionixTunnelPrimitives, STATGROUP_Orionix);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Target Blocks"), STAT_OrionixTargetBlocks, STATGROUP_Orionix);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Runner Speed"), STAT_OrionixRunnerSpeed, STATGROUP_Orionix);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Segments Shown Non-Resident"), STAT_OrionixShownNonResident, STATGROUP_Orionix);
+
+static TAutoConsoleVariable<int32> CVarTunnelRenderMode(
+	TEXT("orionix.Tunnel.RenderMode"),
+	0,
+	TEXT("How tunnel blocks are drawn, read when the tunnel starts.\n")
+	TEXT(" 0: one actor and static mesh component per block\n")
+	TEXT(" 1: one hierarchical instanced static mesh component per block mesh"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<bool> CVarTunnelKeepPhysicsBodies(
+	TEXT("orionix.Tunnel.KeepPhysicsBodies"),
+	true,
+	TEXT("Read when the tunnel starts. If true, recycled blocks stay attached and are parked with their collision ignored,\n")
+	TEXT("so their physics bodies are never destroyed. If false, blocks are detached and their collision is disabled."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarTunnelSeed(
+	TEXT("orionix.Tunnel.Seed"),
+	0,
+	TEXT("Seed of the tunnel's random streams, read when the tunnel starts. 0 picks a new seed every run; the seed is logged either way."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarTunnelRandomTurnChance(
+	TEXT("orionix.Tunnel.RandomTurnChance"),
+	0.0f,
+	TEXT("Chance of a generated tunnel segment carrying a random turn, read when the tunnel starts. 0 disables random turns."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarTunnelTurnQueueSize(
+	TEXT("orionix.Tunnel.TurnQueueSize"),
+	2,
+	TEXT("Turns that can be queued while a turn is in progress, read when the tunnel starts. Later turns are dropped, 0 drops every turn made during a turn."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarTunnelVisibleBlocks(
+	TEXT("orionix.Tunnel.VisibleBlocks"),
+	0,
+	TEXT("Segments drawn from the runner's block onward, the rest of the tunnel is hidden without occlusion queries. This is a draw distance,\n")
+	TEXT("not a conservative cull: the tube has no fog or far plane hiding its far end, so hidden segments pop in as the runner nears them.\n")
+	TEXT("0 draws every segment and leaves the tunnel to the engine's frustum and occlusion culling."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarTunnelLookaheadSeconds(
+	TEXT("orionix.Tunnel.LookaheadSeconds"),
+	4.0f,
+	TEXT("Seconds of running the segments ahead of the runner should cover, the tunnel grows and shrinks with the runner's speed.\n")
+	TEXT("0 keeps the tunnel at maxBlocks segments."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarTunnelMinBlocks(
+	TEXT("orionix.Tunnel.MinBlocks"),
+	4,
+	TEXT("Fewest segments the speed-adaptive tunnel holds, whatever the runner's speed."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarTunnelNearBlocks(
+	TEXT("orionix.Tunnel.NearBlocks"),
+	3,
+	TEXT("Segments from the runner's block onward kept at full fidelity. The rest of the tunnel ignores collision and draws orionix.Tunnel.FarLOD.\n")
+	TEXT("0 keeps every segment at full fidelity."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarTunnelFarLOD(
+	TEXT("orionix.Tunnel.FarLOD"),
+	2,
+	TEXT("Forced LOD model of far segments, 1 is LOD0 and 2 is LOD1. 0 lets the engine pick."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarStreamingPrefetchSeconds(
+	TEXT("orionix.Streaming.PrefetchSeconds"),
+	3.0f,
+	TEXT("Segments the runner reaches within this many seconds get their mesh LODs and texture mips forced resident. 0 disables the prefetch."),
+	ECVF_Default);
+
+static void setOcclusionQueries(UPrimitiveComponent *component, bool bEnabled)
+{
+	if(component && component->bTreatAsBackgroundForOcclusion == bEnabled)
+	{
+		component->bTreatAsBackgroundForOcclusion = !bEnabled;				// Background primitives are never occlusion-queried
+		component->MarkRenderStateDirty();
+	}
+}
+
+static FAutoConsoleCommandWithWorld BlockPoolStatsCommand(
+	TEXT("orionix.Pool.Stats"),
+	TEXT("Logs the size, misses, peak usage and spawn cost of the block pool."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld *World)
+	{
+		for(TActorIterator<ATunnelManager> It(World); It; ++It)
+		{
+			It->logPoolStats();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld TunnelRecycleStatsCommand(
+	TEXT("orionix.Tunnel.RecycleStats"),
+	TEXT("Logs the average and worst cost of a block recycle and the state of the sequence generator."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld *World)
+	{
+		for(TActorIterator<ATunnelManager> It(World); It; ++It)
+		{
+			It->logRecycleStats();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld TurnStatsCommand(
+	TEXT("orionix.Tunnel.TurnStats"),
+	TEXT("Logs the latency from a turn input to the first frame showing the turn, and the queued and dropped turns."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld *World)
+	{
+		for(TActorIterator<ATunnelManager> It(World); It; ++It)
+		{
+			It->logTurnStats();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld LookaheadStatsCommand(
+	TEXT("orionix.Tunnel.LookaheadStats"),
+	TEXT("Logs the runner's speed through the tunnel against the target and live segment counts."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld *World)
+	{
+		for(TActorIterator<ATunnelManager> It(World); It; ++It)
+		{
+			It->logLookaheadStats();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld StreamingStatsCommand(
+	TEXT("orionix.Streaming.Stats"),
+	TEXT("Logs the streaming prefetch hints of the tunnel and the segments that became visible with non-resident LODs or mips."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld *World)
+	{
+		for(TActorIterator<ATunnelManager> It(World); It; ++It)
+		{
+			It->logStreamingStats();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld SimulationStatsCommand(
+	TEXT("orionix.Sim.Stats"),
+	TEXT("Logs the simulated steps and time of the tunnel and its throughput in steps per wall clock second."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld *World)
+	{
+		for(TActorIterator<ATunnelManager> It(World); It; ++It)
+		{
+			It->logSimulationStats();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld TunnelRenderStatsCommand(
+	TEXT("orionix.Tunnel.RenderStats"),
+	TEXT("Logs how many tunnel primitives are left visible, before the engine culls them."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld *World)
+	{
+		for(TActorIterator<ATunnelManager> It(World); It; ++It)
+		{
+			It->logRenderStats();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld MemoryStatsCommand(
+	TEXT("orionix.Memory.Dump"),
+	TEXT("Logs the current and peak memory of the Orionix LLM tags and the memory of the block pool against its warning budget."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld *World)
+	{
+		FOrionixMemory::logTags();
+		for(TActorIterator<ATunnelManager> It(World); It; ++It)
+		{
+			It->logMemoryStats();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs MeasureGarbageCollectionCommand(
+	TEXT("orionix.GC.Measure"),
+	TEXT("Times full garbage collections with the pooled blocks in a GC cluster and without it.\n")
+	TEXT("Usage: orionix.GC.Measure [Collections=10] [ExtraBlocks=0], ExtraBlocks spawns free blocks first to measure a large pool."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString> &Args, UWorld *World)
+	{
+		int32 collections = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 10;
+		int32 extraBlocks = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 0) : 0;
+		for(TActorIterator<ATunnelManager> It(World); It; ++It)
+		{
+			It->measureGarbageCollection(collections, extraBlocks);
+		}
+	}));
+
+static void timeGarbageCollections(int32 collections, const TCHAR *label)
+{
+	double totalSeconds = 0.0;
+	double maxSeconds = 0.0;
+	for(int32 i = 0; i < collections; i++)
+	{
+		double startTime = FPlatformTime::Seconds();
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+		double seconds = FPlatformTime::Seconds() - startTime;
+		totalSeconds += seconds;
+		maxSeconds = FMath::Max(maxSeconds, seconds);
+	}
+	UE_LOG(LogTemp, Warning, TEXT("GC %s: %d collections, Average: %.3f ms, Max: %.3f ms, Objects: %d"),
+		label, collections, totalSeconds * 1000.0 / collections, maxSeconds * 1000.0, GUObjectArray.GetObjectArrayNumMinusAvailable());
+}
 
 // Constructor
 ATunnelManager::ATunnelManager()
@@ -17,122 +244,357 @@ ATunnelManager::~ATunnelManager()
 	blockPool = nullptr;
 }
 
+void ATunnelManager::AddReferencedObjects(UObject *InThis, FReferenceCollector &Collector)
+{
+	ATunnelManager *tunnelManager = CastChecked<ATunnelManager>(InThis);
+	if(tunnelManager->blockPool)
+	{
+		tunnelManager->blockPool->addReferencedObjects(Collector);
+	}
+	Super::AddReferencedObjects(InThis, Collector);
+}
+
 // Protected Functions
 void ATunnelManager::BeginPlay()
 {
 	Super::BeginPlay();
+	LLM_SCOPE_BYTAG(Orionix_TunnelManager);
 	FRotator initialRotation = FRotator(0.f, 90.f, 0.f);
 	tunnelArrow->SetWorldRotation(initialRotation);						// Set arrow component rotation
-	blockPool->initializePool(GetWorld(), ABlock::StaticClass());				// Pool created and filled
-	subscribeToBlockEvents();								// Subscribed to trigger events of block
+	FOrionixTrace::traceSession();
+	initializeSimulation();
+	renderMode = CVarTunnelRenderMode.GetValueOnGameThread() == 1 ? ETunnelRenderMode::Instanced : ETunnelRenderMode::Actors;
+	keepPhysicsBodies = CVarTunnelKeepPhysicsBodies.GetValueOnGameThread();
+	instanceParkingLocation = startPosition - blockOffset * 20;				// Far behind the player, out of the camera's view
+	initializeRandomStreams();
+	blockPool->onCatalogReady.AddUObject(this, &ATunnelManager::handleCatalogReady);
+	blockPool->onBlockDestroying.AddUObject(this, &ATunnelManager::handleBlockDestroying);
+	blockPool->setClusteringAllowed(keepPhysicsBodies);					// Detaching on every recycle would change the references of clustered blocks
+	blockPool->initializePool(GetWorld(), ABlock::StaticClass(), renderMode == ETunnelRenderMode::Actors, maxBlocks);	// Only the blocks of the first tunnel are spawned now, the rest is warmed up by Tick
+	blockInstances.SetNum(blockPool->getMeshCount());
+	freeInstanceSlots.SetNum(blockPool->getMeshCount());
+	FTunnelSequenceRules sequenceRules;
+	sequenceRules.lookahead = maxBlocks * 4;
+	sequenceRules.turnChance = CVarTunnelRandomTurnChance.GetValueOnGameThread();
+	if(soakBenchmark.isRunning())
+	{
+		sequenceRules.turnChance = FMath::Max(sequenceRules.turnChance, 0.1f);		// A soak run also exercises the turns
+	}
+	TArray<float> blockWeights;
+	blockPool->getBlockWeights(blockWeights);
+	sequenceGenerator.start(blockWeights, sequenceRules, randomStreams.getStreamSeed(ETunnelRandomStream::Sequence));			// Fills the first lookahead before the tunnel is built
 	initializeTunnel();									// Tunnel initialized
 	
 	//triggerRandomTurn();
 }
 
-void ATunnelManager::OnTriggerBoxOverlapLeft(UPrimitiveComponent *OverlappedComponent, AActor *OtherActor, UPrimitiveComponent *OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult &SweepResult)
+void ATunnelManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	if(!isRotationInProgress)
+	sequenceGenerator.stop();
+	if(replay.getMode() == ETunnelReplayMode::Recording)
 	{
-		isRotatingLeft = true;
-		isRotationInProgress = true;
+		replay.save(replayRecordPath);
 	}
+	Super::EndPlay(EndPlayReason);
+}
+
+void ATunnelManager::OnTriggerBoxOverlapLeft(UPrimitiveComponent *OverlappedComponent, AActor *OtherActor, UPrimitiveComponent *OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult &SweepResult)
+{
+	turnLeft();
 }
 
 void ATunnelManager::OnTriggerBoxOverlapRight(UPrimitiveComponent *OverlappedComponent, AActor *OtherActor, UPrimitiveComponent *OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult &SweepResult)
 {
-	if(!isRotationInProgress)
-	{
-		isRotatingRight = true;
-		isRotationInProgress = true;
-	}
+	turnRight();
 }
 
 // Public Functions
 void ATunnelManager::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
-	updateRotation(DeltaTime);
+	SCOPE_CYCLE_COUNTER(STAT_OrionixTunnelTick);
+	CSV_SCOPED_TIMING_STAT(Orionix, TunnelTick);
+	FOrionixTrace::traceFrame(DeltaTime);
+	soakBenchmark.tickFrame();
+	blockPool->tick();
+	updateLookahead(DeltaTime);
+	fillTunnel();
+
+	int32 steps = simulationClock.advance(DeltaTime);
+	for(int32 i = 0; i < steps; i++)
+	{
+		stepSimulation(simulationClock.getStepSeconds());
+		simulationClock.finishStep();
+	}
+	applySimulationState(simulationClock.getInterpolationAlpha());
+	updateStreamingPrefetch();
+	updateVisibleSet();
+	updateDetailLevels();
+	recordTurnLatency();
+	updateStats(DeltaTime);
+
+	if(headlessSimulationSeconds > 0.0 && simulationClock.getSimulatedSeconds() >= headlessSimulationSeconds)
+	{
+		headlessSimulationSeconds = 0.0;
+		logSimulationStats();
+		FPlatformMisc::RequestExit(false);
+	}
+
+	if(soakBenchmark.isComplete() && !IsEngineExitRequested())
+	{
+		logSimulationStats();
+		logRecycleStats();
+		soakBenchmark.writeReport();
+		FPlatformMisc::RequestExit(false);
+	}
 }
 
-void ATunnelManager::initializeTunnel()
+void ATunnelManager::stepSimulation(float StepSeconds)
 {
-	for(int32 i = 0; i < maxBlocks; i++)
+	playReplayInputs();
+	if(!runner.IsValid())
+	{
+		runner = UGameplayStatics::GetPlayerPawn(this, 0);
+	}
+
+	TOptional<FVector> runnerLocation;
+	if(runner.IsValid())
+	{
+		runnerLocation = runner->GetActorLocation();
+	}
+	if(AOrionixCharacter *runnerCharacter = Cast<AOrionixCharacter>(runner.Get()))
 	{
-		ABlock *newBlock = blockPool->getBlockRandomly();
-		if(!newBlock) return;
-		addBlockToBuffer(newBlock);
-		newBlock->rotateBlockRandomly();
-		newBlock->AttachToComponent(tunnelArrow, FAttachmentTransformRules::SnapToTargetNotIncludingScale);
-		newBlock->setBlockLocation(startPosition);
-		startPosition += blockOffset;
-		newBlock->unhideAndEnableCollision();
+		runnerCharacter->stepSpeed(StepSeconds);
 	}
+	if(tunnelModel.step(StepSeconds, runnerLocation) > 0)
+	{
+		syncTriggerBoxes();
+	}
+	updateRunnerFloor();
 }
 
-void ATunnelManager::subscribeToBlockEvents()
+void ATunnelManager::updateRunnerFloor()
 {
-	for(int32 i = 0; i < blockPool->getPoolSize(); i++)
+	ACharacter *runnerCharacter = Cast<ACharacter>(runner.Get());
+	URunnerMovementComponent *runnerMovement = runnerCharacter ? Cast<URunnerMovementComponent>(runnerCharacter->GetCharacterMovement()) : nullptr;
+	if(!runnerMovement)
 	{
-		ABlock *block = blockPool->getBlockByIndex(i);
-		if(block != nullptr)
-		{
-			block->onBlockTriggered.AddDynamic(this, &ATunnelManager::handleBlockTrigger);
-		}
+		return;
 	}
+
+	UPrimitiveComponent *floorComponent = nullptr;
+	bool bSolidFloor = false;
+	int64 floorSegment = INDEX_NONE;
+	const FTunnelSegmentBuffer &tunnelSegments = tunnelModel.getSegments();
+	if(tunnelSegments.num() > 0)
+	{
+		const FTunnelSegment &runnerSegment = tunnelSegments.first();			// The runner is on the oldest block until it triggers
+		floorSegment = runnerSegment.segmentNumber;
+		floorComponent = getSegmentComponent(runnerSegment);
+		bSolidFloor = hasSolidFloor(runnerSegment) && (tunnelSegments.num() < 2 || hasSolidFloor(tunnelSegments.getAt(1)));	// The capsule reaches over the next block before the trigger
+	}
+	runnerMovement->setTunnelFloor(!tunnelModel.isTurning(), bSolidFloor, floorSegment, floorComponent);
+}
+
+void ATunnelManager::applySimulationState(float interpolationAlpha)
+{
+	FTransform arrowTransform = tunnelModel.getInterpolatedFrame(interpolationAlpha);
+	tunnelArrow->SetWorldLocationAndRotation(arrowTransform.GetLocation(), arrowTransform.GetRotation());
 }
 
-void ATunnelManager::addBlockToTunnel()
+void ATunnelManager::updateStats(float DeltaTime)
 {
-	ABlock *newBlock = blockPool->getBlockRandomly();
-	if(!newBlock) return;
+	// Recycles come a few per second, so the rate is published once per window instead of as a per-frame quotient
+	int64 recycleCount = tunnelModel.getProgress().getTriggerCount();
+	statRecycleWindowSeconds += DeltaTime;
+	if(statRecycleWindowSeconds >= 1.0)
+	{
+		statRecyclesPerSecond = (uint32)FMath::RoundToInt((recycleCount - statRecycleCount) / statRecycleWindowSeconds);
+		statRecycleCount = recycleCount;
+		statRecycleWindowSeconds = 0.0;
+	}
+	uint32 recyclesPerSecond = statRecyclesPerSecond;
+	uint32 liveBlocks = (uint32)tunnelModel.getSegments().num();
+	uint32 pooledBlocks = (uint32)blockPool->getPoolSize();
+	float rotationSeconds = (float)tunnelModel.getTurningSeconds();
+	uint32 tunnelPrimitives = (uint32)countVisiblePrimitives();
 
-	newBlock->rotateBlockRandomly();
-	newBlock->AttachToComponent(tunnelArrow, FAttachmentTransformRules::SnapToTargetNotIncludingScale);
-	ABlock *lastBlock = tunnelBlocks.Last();
-	FVector lastestBlockPosition = lastBlock->GetRootComponent()->GetRelativeLocation();
-	FVector newLocation = lastestBlockPosition + blockOffset;
-	newBlock->setBlockLocation(newLocation);
-	addBlockToBuffer(newBlock);
-	newBlock->unhideAndEnableCollision();
+	SET_DWORD_STAT(STAT_OrionixLiveBlocks, liveBlocks);
+	SET_DWORD_STAT(STAT_OrionixPooledBlocks, pooledBlocks);
+	SET_DWORD_STAT(STAT_OrionixRecyclesPerSecond, recyclesPerSecond);
+	SET_FLOAT_STAT(STAT_OrionixRotationTime, rotationSeconds);
+	SET_DWORD_STAT(STAT_OrionixVisibleBlocks, (uint32)visibleBlockCount);
+	SET_DWORD_STAT(STAT_OrionixTunnelPrimitives, tunnelPrimitives);
+	SET_DWORD_STAT(STAT_OrionixTargetBlocks, (uint32)tunnelModel.getTargetSegments());
+	SET_FLOAT_STAT(STAT_OrionixRunnerSpeed, runnerSpeed);
+	SET_DWORD_STAT(STAT_OrionixShownNonResident, (uint32)streamingPrefetch.getNonResidentShownCount());
+	CSV_CUSTOM_STAT(Orionix, LiveBlocks, (int32)liveBlocks, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(Orionix, PooledBlocks, (int32)pooledBlocks, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(Orionix, RecyclesPerSecond, (int32)recyclesPerSecond, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(Orionix, RotationInProgressTime, rotationSeconds, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(Orionix, VisibleBlocks, visibleBlockCount, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(Orionix, TunnelPrimitives, (int32)tunnelPrimitives, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(Orionix, TargetBlocks, tunnelModel.getTargetSegments(), ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(Orionix, RunnerSpeed, runnerSpeed, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(Orionix, ShownNonResident, (int32)streamingPrefetch.getNonResidentShownCount(), ECsvCustomStatOp::Set);
 }
 
-void ATunnelManager::removeBlockFromTunnel()
+void ATunnelManager::initializeSimulation()
 {
-	ABlock *oldestBlock = tunnelBlocks[0];
+	double stepSeconds = FFixedTimestep::getConfiguredStepSeconds();
+	int32 maxStepsPerFrame = 8;
+
+	// Headless runs step the simulation as fast as the CPU allows: the engine advances a fixed time per frame without waiting for real time
+	bool soak = soakBenchmark.initialize();
+	if(soak || FParse::Param(FCommandLine::Get(), TEXT("OrionixHeadless")))
+	{
+		stepSeconds = stepSeconds > 0.0 ? stepSeconds : 1.0 / 60.0;
+		int32 stepsPerFrame = 1;
+		FParse::Value(FCommandLine::Get(), TEXT("OrionixStepsPerFrame="), stepsPerFrame);
+		maxStepsPerFrame = FMath::Max(stepsPerFrame, 1);
+		FParse::Value(FCommandLine::Get(), TEXT("OrionixSimSeconds="), headlessSimulationSeconds);
+		FApp::SetBenchmarking(true);
+		FApp::SetUseFixedTimeStep(true);
+		FApp::SetFixedDeltaTime(stepSeconds * maxStepsPerFrame);
+		UE_LOG(LogTemp, Log, TEXT("Headless simulation: %.2f Hz, %d steps per frame, %s"), 1.0 / stepSeconds, maxStepsPerFrame,
+			FApp::CanEverRender() ? TEXT("rendering (add -nullrhi for full speed)") : TEXT("no rendering"));
+	}
+
+	simulationClock.initialize(stepSeconds, maxStepsPerFrame);
+	simulationWallStartTime = FPlatformTime::Seconds();
+}
+
+void ATunnelManager::initializeTunnel()
+{
+	FTunnelModelSettings modelSettings;
+	modelSettings.maxSegments = maxBlocks;
+	modelSettings.startPosition = startPosition;
+	modelSettings.tunnelAxis = blockOffset;
+	modelSettings.platformVelocity = platformVelocity;
+	modelSettings.triggerBoxOffset = triggerBoxOffset;
+	modelSettings.frameLocation = tunnelArrow->GetComponentLocation();
+	modelSettings.frameRotation = tunnelArrow->GetComponentQuat();
+	modelSettings.turnDuration = turnDuration;
+	modelSettings.turnEasing = [this](float rotationAlpha) { return easeTurn(rotationAlpha); };
+	modelSettings.turnQueueCapacity = FMath::Max(CVarTunnelTurnQueueSize.GetValueOnGameThread(), 0);
+	tunnelModel.initialize(modelSettings, this);
+	runnerSpeed = platformVelocity.Size();							// A standing runner, the measured speed takes over from the first frame
+	streamingPrefetch.initialize(blockPool->getMeshCount());
+	lastPrefetchedSegment = INDEX_NONE;
+	lastShownSegment = INDEX_NONE;
+
+	segmentBlocks.Reset();
+	segmentBlocks.SetNumZeroed(tunnelModel.getSegments().getCapacity());
+	syncTriggerBoxes();
+	fillTunnel();
+}
+
+void ATunnelManager::fillTunnel()
+{
+	if(blockPool->getPoolSize() > 0)
+	{
+		tunnelModel.fill();
+	}
+}
+
+bool ATunnelManager::provideSegment(bool bFirstSegment, FTunnelSegmentDescriptor &outDescriptor, float &outLength)
+{
+	outDescriptor = FTunnelSegmentDescriptor();
+	ABlock *newBlock = bFirstSegment ? blockPool->getStarterBlock() : nullptr;		// The tunnel always starts with the starter block
+	newBlock = newBlock ? newBlock : acquireNextBlock(outDescriptor);
+	if(!newBlock) return false;
+
+	outDescriptor.meshIndex = newBlock->meshIndex;						// The starter block, or the pool's pick when the generator fell behind
+	outLength = newBlock->blockLength;
+	pendingBlock = newBlock;
+	return true;
+}
+
+void ATunnelManager::onSegmentAdded(const FTunnelSegment &segment)
+{
+	SCOPE_CYCLE_COUNTER(STAT_OrionixAddBlockToTunnel);
+	CSV_SCOPED_TIMING_STAT(Orionix, AddBlockToTunnel);
+	ABlock *newBlock = pendingBlock;
+	pendingBlock = nullptr;
+	segmentBlocks[segment.segmentNumber % segmentBlocks.Num()] = newBlock;
+	replay.recordSegment(segment.meshIndex);
+	if(renderMode == ETunnelRenderMode::Actors)
+	{
+		newBlock->setFarDetail(isFarSegment(tunnelModel.getSegments().num() - 1), CVarTunnelFarLOD.GetValueOnGameThread());	// Before placing, so a far block never gets its collision back
+	}
+	placeBlock(newBlock, segment.location, segment.rollSteps);
+}
+
+void ATunnelManager::onBlockTriggerHandled(double seconds)
+{
+	soakBenchmark.recordRecycle(seconds);
+}
+
+void ATunnelManager::onSegmentRemoved(const FTunnelSegment &segment)
+{
+	SCOPE_CYCLE_COUNTER(STAT_OrionixRemoveBlockFromTunnel);
+	CSV_SCOPED_TIMING_STAT(Orionix, RemoveBlockFromTunnel);
+	ABlock *oldestBlock = getSegmentBlock(segment);
 	if(oldestBlock != nullptr)
 	{
-		oldestBlock->hideAndDisableCollision();
-		oldestBlock->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
-		oldestBlock->flag = false;
+		if(keepPhysicsBodies)
+		{
+			oldestBlock->parkAndIgnoreCollision(blockParkingLocation);
+		}
+		else
+		{
+			oldestBlock->hideAndDisableCollision();
+			oldestBlock->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+		}
+		updateBlockInstance(oldestBlock, false);
+		FOrionixTrace::traceBlock(EOrionixBlockEvent::Returned, oldestBlock->GetUniqueID(), segment.segmentNumber, segment.meshIndex);
 		blockPool->returnBlock(oldestBlock);
 	}
-	removeBlockFromBuffer();
+	segmentBlocks[segment.segmentNumber % segmentBlocks.Num()] = nullptr;
 }
 
-void ATunnelManager::handleBlockTrigger()
+void ATunnelManager::turnLeft()
 {
-	addBlockToTunnel();
-	removeBlockFromTunnel();
-	moveTriggerBoxesForward();
+	tunnelModel.turn(ETunnelTurn::Left);
 }
 
-void ATunnelManager::turnLeft()
+void ATunnelManager::turnRight()
+{
+	tunnelModel.turn(ETunnelTurn::Right);
+}
+
+void ATunnelManager::handleTurnInput(ETunnelTurn turn)
 {
-	if(!isRotationInProgress)
+	if(replay.getMode() == ETunnelReplayMode::Playback)
 	{
-		isRotatingLeft = true;
-		isRotationInProgress = true;
+		return;										// The replay provides the inputs
 	}
+	replay.recordInput((uint32)simulationClock.getStepCount(), (float)simulationClock.getSimulatedSeconds(), turn);
+	FOrionixTrace::traceTurn(EOrionixTurnEvent::Input, (uint8)turn);
+	tunnelModel.turn(turn, FPlatformTime::Seconds());
 }
 
-void ATunnelManager::turnRight()
+void ATunnelManager::recordTurnLatency()
 {
-	if(!isRotationInProgress)
+	double inputTime = 0.0;
+	if(!tunnelModel.takeStartedTurnInput(inputTime))
 	{
-		isRotatingRight = true;
-		isRotationInProgress = true;
+		return;
 	}
+
+	double latency = FPlatformTime::Seconds() - inputTime;
+	turnLatencyCount++;
+	totalTurnLatency += latency;
+	maxTurnLatency = FMath::Max(maxTurnLatency, latency);
+	SET_FLOAT_STAT(STAT_OrionixTurnInputLatency, (float)(latency * 1000.0));
+	CSV_CUSTOM_STAT(Orionix, TurnInputLatencyMs, (float)(latency * 1000.0), ECsvCustomStatOp::Set);
+}
+
+void ATunnelManager::logTurnStats() const
+{
+	UE_LOG(LogTemp, Warning, TEXT("Turn Inputs: %lld, Input To Rotated Frame Average: %.2f ms, Max: %.2f ms, Queued: %d, Dropped: %lld"),
+		turnLatencyCount, turnLatencyCount > 0 ? totalTurnLatency * 1000.0 / turnLatencyCount : 0.0, maxTurnLatency * 1000.0,
+		tunnelModel.getQueuedTurnCount(), tunnelModel.getDroppedTurnCount());
 }
 
 void ATunnelManager::triggerRandomTurn()
@@ -140,10 +602,11 @@ void ATunnelManager::triggerRandomTurn()
 	float minDelay = 4.0f;
 	float maxDelay = 7.0f;
 
-	float randomDelay = FMath::RandRange(minDelay, maxDelay);
+	FRandomStream &randomStream = randomStreams.get(ETunnelRandomStream::Tunnel);
+	float randomDelay = randomStream.FRandRange(minDelay, maxDelay);
 	GetWorld()->GetTimerManager().SetTimer(TurnTimerHandle, this, &ATunnelManager::onTurnTimerExpired, randomDelay, false);
 
-	int32 randomDirection = FMath::RandRange(0, 1);
+	int32 randomDirection = randomStream.RandRange(0, 1);
 	if(randomDirection == 0)
 	{
 		turnLeft();
@@ -159,6 +622,244 @@ void ATunnelManager::onTurnTimerExpired()
 	triggerRandomTurn();
 }
 
+void ATunnelManager::handleCatalogReady()
+{
+	UE_LOG(LogTemp, Log, TEXT("Block catalog ready: %d blocks after %.2f ms"), blockPool->getTotalBlockCount(), blockPool->getTimeToFullPool() * 1000.0);
+	onBlockCatalogReady.Broadcast();
+}
+
+void ATunnelManager::logMemoryStats() const
+{
+	blockPool->logMemoryUsage();
+	logTunnelBlocksMemorySize();
+}
+
+void ATunnelManager::measureGarbageCollection(int32 collections, int32 extraBlocks)
+{
+	int32 spawnedBlocks = blockPool->spawnBlocks(extraBlocks);
+	bool wasClustered = blockPool->isClustered();
+	UE_LOG(LogTemp, Warning, TEXT("Measuring GC with %d pooled blocks (%d extra)"), blockPool->getTotalBlockCount(), spawnedBlocks);
+
+	blockPool->rebuildCluster();
+	timeGarbageCollections(collections, blockPool->isClustered() ? TEXT("Clustered") : TEXT("Clustered (no cluster created, see gc.CreateGCClusters)"));
+	blockPool->dissolveCluster();
+	timeGarbageCollections(collections, TEXT("Unclustered"));
+
+	if(wasClustered)
+	{
+		blockPool->rebuildCluster();
+	}
+}
+
+void ATunnelManager::logPoolStats() const
+{
+	blockPool->getPoolStatus();
+}
+
+void ATunnelManager::logRecycleStats() const
+{
+	double averageRecycleTime = 0.0;
+	double maxRecycleTime = 0.0;
+	int64 recycleCount = tunnelModel.getRecycleStats(averageRecycleTime, maxRecycleTime);
+	UE_LOG(LogTemp, Warning, TEXT("Recycle Mode: %s, Recycles: %lld, Average: %.2f us, Max: %.2f us"),
+		keepPhysicsBodies ? TEXT("Park") : TEXT("Disable Collision"), recycleCount, averageRecycleTime * 1000000.0, maxRecycleTime * 1000000.0);
+	sequenceGenerator.logStatus();
+	UE_LOG(LogTemp, Warning, TEXT("Pool Misses: %lld, Type Misses: %lld"), blockPool->getCounters().misses, blockPool->getTypeMissCount());
+}
+
+void ATunnelManager::logSimulationStats() const
+{
+	double wallSeconds = FPlatformTime::Seconds() - simulationWallStartTime;
+	double simulatedSeconds = simulationClock.getSimulatedSeconds();
+	UE_LOG(LogTemp, Warning, TEXT("Simulation Steps: %lld, Simulated: %.1f s, Wall: %.1f s, Throughput: %.0f steps/s, Speed: %.2fx real time, Dropped: %.2f s"),
+		simulationClock.getStepCount(), simulatedSeconds, wallSeconds, wallSeconds > 0.0 ? simulationClock.getStepCount() / wallSeconds : 0.0,
+		wallSeconds > 0.0 ? simulatedSeconds / wallSeconds : 0.0, simulationClock.getDroppedSeconds());
+}
+
+void ATunnelManager::logRenderStats() const
+{
+	const FTunnelSegmentBuffer &tunnelSegments = tunnelModel.getSegments();
+	int32 visiblePrimitives = countVisiblePrimitives();
+
+	int32 instancedComponents = 0;
+	for(const UHierarchicalInstancedStaticMeshComponent *instances : blockInstances)
+	{
+		instancedComponents += instances ? 1 : 0;
+	}
+
+	UE_LOG(LogTemp, Warning, TEXT("Render Mode: %s, Tunnel Blocks: %d, Visible Blocks: %d, Primitives Left Visible: %d, Pooled Actors: %d, Instanced Components: %d"),
+		renderMode == ETunnelRenderMode::Instanced ? TEXT("Instanced") : TEXT("Actors"), tunnelSegments.num(), visibleBlockCount, visiblePrimitives, blockPool->getTotalBlockCount(), instancedComponents);
+}
+
+int32 ATunnelManager::countVisiblePrimitives() const
+{
+	const FTunnelSegmentBuffer &tunnelSegments = tunnelModel.getSegments();
+	int32 drawnSegments = FMath::Min(visibleBlockCount, tunnelSegments.num());
+	if(renderMode == ETunnelRenderMode::Instanced)
+	{
+		TSet<int32> visibleMeshes;						// One instanced component is drawn per visible mesh type
+		for(int32 i = 0; i < drawnSegments; i++)
+		{
+			visibleMeshes.Add(tunnelSegments.getAt(i).meshIndex);
+		}
+		return visibleMeshes.Num();
+	}
+
+	int32 visiblePrimitives = 0;
+	for(int32 i = 0; i < tunnelSegments.num(); i++)
+	{
+		ABlock *block = getSegmentBlock(tunnelSegments.getAt(i));
+		visiblePrimitives += block && !block->IsHidden() && block->meshComponent->IsVisible() ? 1 : 0;
+	}
+	return visiblePrimitives;
+}
+
+void ATunnelManager::updateLookahead(float DeltaTime)
+{
+	const FTunnelSegmentBuffer &tunnelSegments = tunnelModel.getSegments();
+	float lookaheadSeconds = CVarTunnelLookaheadSeconds.GetValueOnGameThread();
+	if(lookaheadSeconds <= 0.0f || tunnelSegments.num() == 0)
+	{
+		tunnelModel.setTargetSegments(maxBlocks);
+		return;
+	}
+
+	// The runner moves through the tunnel with its own velocity plus the scrolling of the tunnel
+	FVector worldTunnelAxis = tunnelModel.getFrame().TransformVectorNoScale(tunnelModel.getTunnelAxis());
+	FVector runnerVelocity = runner.IsValid() ? runner->GetVelocity() : FVector::ZeroVector;
+	float measuredSpeed = FMath::Max((float)FVector::DotProduct(runnerVelocity - platformVelocity, worldTunnelAxis), 0.0f);
+	runnerSpeed = FMath::FInterpTo(runnerSpeed, measuredSpeed, DeltaTime, 4.0f);
+
+	float totalLength = 0.0f;
+	for(int32 i = 0; i < tunnelSegments.num(); i++)
+	{
+		totalLength += tunnelSegments.getAt(i).length;
+	}
+	float averageLength = FMath::Max(totalLength / tunnelSegments.num(), 1.0f);
+	int32 aheadSegments = FMath::CeilToInt32(runnerSpeed * lookaheadSeconds / averageLength);
+	int32 minBlocks = FMath::Clamp(CVarTunnelMinBlocks.GetValueOnGameThread(), 1, maxBlocks);
+	tunnelModel.setTargetSegments(FMath::Clamp(aheadSegments + 1, minBlocks, maxBlocks));	// Plus the runner's own block
+}
+
+void ATunnelManager::updateDetailLevels()
+{
+	if(renderMode != ETunnelRenderMode::Actors)
+	{
+		return;
+	}
+
+	const FTunnelSegmentBuffer &tunnelSegments = tunnelModel.getSegments();
+	int32 farLodModel = CVarTunnelFarLOD.GetValueOnGameThread();
+	for(int32 i = 0; i < tunnelSegments.num(); i++)
+	{
+		ABlock *block = getSegmentBlock(tunnelSegments.getAt(i));
+		if(block)
+		{
+			block->setFarDetail(isFarSegment(i), farLodModel);			// Does nothing unless the block crossed the near window
+		}
+	}
+}
+
+bool ATunnelManager::isFarSegment(int32 segmentIndex) const
+{
+	int32 nearBlocks = CVarTunnelNearBlocks.GetValueOnGameThread();
+	return nearBlocks > 0 && segmentIndex >= nearBlocks;
+}
+
+void ATunnelManager::logLookaheadStats() const
+{
+	const FTunnelSegmentBuffer &tunnelSegments = tunnelModel.getSegments();
+	float aheadLength = 0.0f;
+	for(int32 i = 1; i < tunnelSegments.num(); i++)
+	{
+		aheadLength += tunnelSegments.getAt(i).length;
+	}
+	UE_LOG(LogTemp, Warning, TEXT("Runner Speed: %.0f, Target Blocks: %d, Live Blocks: %d, Max Blocks: %d, Ahead: %.0f units, %.2f s"),
+		runnerSpeed, tunnelModel.getTargetSegments(), tunnelSegments.num(), maxBlocks, aheadLength, runnerSpeed > 0.0f ? aheadLength / runnerSpeed : 0.0f);
+}
+
+void ATunnelManager::updateStreamingPrefetch()
+{
+	float prefetchSeconds = CVarStreamingPrefetchSeconds.GetValueOnGameThread();
+	if(prefetchSeconds <= 0.0f)
+	{
+		return;
+	}
+
+	const FTunnelSegmentBuffer &tunnelSegments = tunnelModel.getSegments();
+	double runnerDistance = tunnelModel.getProgress().getProgress();
+	float speed = FMath::Max(runnerSpeed, 1.0f);
+	for(int32 i = 0; i < tunnelSegments.num(); i++)
+	{
+		const FTunnelSegment &segment = tunnelSegments.getAt(i);
+		float arrivalSeconds = FMath::Max((float)(FVector::DotProduct(segment.location, tunnelModel.getTunnelAxis()) - runnerDistance), 0.0f) / speed;
+		if(arrivalSeconds > prefetchSeconds)
+		{
+			break;										// Segments are ordered along the tunnel
+		}
+		if(segment.segmentNumber > lastPrefetchedSegment)
+		{
+			// Once the block is on screen the streamer keeps it resident by itself, the margin covers the handover
+			streamingPrefetch.prefetch(segment.meshIndex, blockPool->getBlockMesh(segment.meshIndex), arrivalSeconds + 2.0f);
+			lastPrefetchedSegment = segment.segmentNumber;
+		}
+	}
+}
+
+void ATunnelManager::logStreamingStats() const
+{
+	streamingPrefetch.logStatus();
+}
+
+void ATunnelManager::updateVisibleSet()
+{
+	const FTunnelSegmentBuffer &tunnelSegments = tunnelModel.getSegments();
+	int32 visibleBlocks = CVarTunnelVisibleBlocks.GetValueOnGameThread();
+	bool bCullTunnel = visibleBlocks > 0;
+	visibleBlockCount = bCullTunnel ? FMath::Min(visibleBlocks, tunnelSegments.num()) : tunnelSegments.num();
+	for(int32 i = 0; i < visibleBlockCount; i++)
+	{
+		const FTunnelSegment &segment = tunnelSegments.getAt(i);
+		if(segment.segmentNumber > lastShownSegment)
+		{
+			streamingPrefetch.recordShown(segment.meshIndex, blockPool->getBlockMesh(segment.meshIndex));
+			lastShownSegment = segment.segmentNumber;
+		}
+	}
+
+	if(renderMode == ETunnelRenderMode::Instanced)
+	{
+		// Instances cannot be hidden one by one without moving them, so the instanced components stop drawing past the visible segments
+		int32 endCullDistance = 0;
+		if(bCullTunnel && visibleBlockCount > 0 && visibleBlockCount < tunnelSegments.num())
+		{
+			const FTunnelSegment &runnerSegment = tunnelSegments.first();
+			const FTunnelSegment &lastVisibleSegment = tunnelSegments.getAt(visibleBlockCount - 1);
+			float visibleLength = FVector::DotProduct(lastVisibleSegment.location - runnerSegment.location, tunnelModel.getTunnelAxis()) + lastVisibleSegment.length;
+			endCullDistance = FMath::CeilToInt32(visibleLength + runnerSegment.length);	// One block of margin for the camera behind the runner
+		}
+		for(UHierarchicalInstancedStaticMeshComponent *instances : blockInstances)
+		{
+			if(instances && instances->InstanceEndCullDistance != endCullDistance)
+			{
+				instances->SetCullDistances(0, endCullDistance);
+			}
+			setOcclusionQueries(instances, !bCullTunnel);
+		}
+		return;
+	}
+
+	for(int32 i = 0; i < tunnelSegments.num(); i++)
+	{
+		ABlock *block = getSegmentBlock(tunnelSegments.getAt(i));
+		if(block)
+		{
+			block->setMeshVisible(i < visibleBlockCount);
+			setOcclusionQueries(block->meshComponent, !bCullTunnel);
+		}
+	}
+}
+
 // Private Functions
 void ATunnelManager::generateTriggerBoxPairs()
 {
@@ -167,7 +868,7 @@ void ATunnelManager::generateTriggerBoxPairs()
 
 	triggerBoxLeft->SetupAttachment(RootComponent);
 	triggerBoxLeft->SetBoxExtent(FVector(10.0f, 2400.0f, 250.0f));
-	triggerBoxLeft->SetRelativeLocation(FVector(-1600.0f, 250.0f, 500.0f));
+	triggerBoxLeft->SetRelativeLocation(triggerBoxLeftLocation);
 	triggerBoxLeft->SetRelativeRotation(FRotator(0.0f, 90.0f, 0.0f));
 	triggerBoxLeft->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
 	triggerBoxLeft->SetCollisionResponseToAllChannels(ECR_Ignore);
@@ -176,7 +877,7 @@ void ATunnelManager::generateTriggerBoxPairs()
 
 	triggerBoxRight->SetupAttachment(RootComponent);
 	triggerBoxRight->SetBoxExtent(FVector(10.0f, 2400.0f, 250.0f));
-	triggerBoxRight->SetRelativeLocation(FVector(-1600.0f, -250.0f, 500.0f));
+	triggerBoxRight->SetRelativeLocation(triggerBoxRightLocation);
 	triggerBoxRight->SetRelativeRotation(FRotator(0.0f, 90.0f, 0.0f));
 	triggerBoxRight->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
 	triggerBoxRight->SetCollisionResponseToAllChannels(ECR_Ignore);
@@ -184,53 +885,218 @@ void ATunnelManager::generateTriggerBoxPairs()
 	//triggerBoxRight->OnComponentBeginOverlap.AddDynamic(this, &ATunnelManager::OnTriggerBoxOverlapRight);
 }
 
-void ATunnelManager::addBlockToBuffer(ABlock *newBlock)
+void ATunnelManager::initializeRandomStreams()
 {
-	tunnelBlocks.Add(newBlock);
+	int32 seed = CVarTunnelSeed.GetValueOnGameThread();
+	FString replayPath;
+	if(FParse::Value(FCommandLine::Get(), TEXT("OrionixReplay="), replayPath) && replay.startPlayback(replayPath))
+	{
+		seed = replay.getSeed();
+	}
+	else
+	{
+		seed = seed != 0 ? seed : (int32)FPlatformTime::Cycles();
+		if(FParse::Value(FCommandLine::Get(), TEXT("OrionixRecordReplay="), replayRecordPath))
+		{
+			replay.startRecording(seed);
+		}
+	}
+
+	randomStreams.initialize(seed);
+	blockPool->setRandomStream(&randomStreams.get(ETunnelRandomStream::Pool));
+	UE_LOG(LogTemp, Log, TEXT("Tunnel seed: %d"), seed);
+}
+
+void ATunnelManager::playReplayInputs()
+{
+	if(replay.getMode() != ETunnelReplayMode::Playback || replayVerified)
+	{
+		return;
+	}
+
+	uint32 step = (uint32)simulationClock.getStepCount();
+	for(ETunnelTurn turn = replay.pollInput(step); turn != ETunnelTurn::None; turn = replay.pollInput(step))
+	{
+		tunnelModel.turn(turn);
+	}
+
+	if(replay.isPlaybackComplete())
+	{
+		replayVerified = true;
+		replay.verifyPlayback();
+		if(FParse::Param(FCommandLine::Get(), TEXT("OrionixReplayExit")))
+		{
+			FPlatformMisc::RequestExit(false);
+		}
+	}
+}
+
+ABlock *ATunnelManager::acquireNextBlock(FTunnelSegmentDescriptor &outDescriptor)
+{
+	bool hasDescriptor = sequenceGenerator.peek(outDescriptor);
+	if(!hasDescriptor)
+	{
+		outDescriptor = FTunnelSegmentDescriptor();					// The generator fell behind, the pool picks the block
+		outDescriptor.rollSteps = randomStreams.get(ETunnelRandomStream::Tunnel).RandRange(0, 3);
+	}
+
+	ABlock *newBlock = blockPool->getBlockOfType(outDescriptor.meshIndex);
+	if(!newBlock)
+	{
+		return nullptr;									// The descriptor is kept for the next block that can be placed
+	}
+
+	if(hasDescriptor)
+	{
+		sequenceGenerator.pop();
+	}
+	else
+	{
+		sequenceGenerator.recordStarvation();
+	}
+	return newBlock;
+}
+
+ABlock *ATunnelManager::getSegmentBlock(const FTunnelSegment &segment) const
+{
+	return segmentBlocks.Num() > 0 ? segmentBlocks[segment.segmentNumber % segmentBlocks.Num()] : nullptr;
+}
+
+UPrimitiveComponent *ATunnelManager::getSegmentComponent(const FTunnelSegment &segment) const
+{
+	if(renderMode == ETunnelRenderMode::Instanced)
+	{
+		return blockInstances.IsValidIndex(segment.meshIndex) ? blockInstances[segment.meshIndex] : nullptr;
+	}
+	ABlock *block = getSegmentBlock(segment);
+	return block ? block->meshComponent : nullptr;
+}
+
+bool ATunnelManager::hasSolidFloor(const FTunnelSegment &segment) const
+{
+	UPrimitiveComponent *component = getSegmentComponent(segment);
+	if(!component)
+	{
+		return false;
+	}
+	FVector localDown = component->GetComponentQuat().UnrotateVector(FVector::DownVector);	// Follows the roll of the block and the turns of the tunnel
+	return blockPool->hasSolidFloor(segment.meshIndex, localDown);
+}
+
+float ATunnelManager::easeTurn(float rotationAlpha) const
+{
+	switch(turnEasing)
+	{
+	case ETunnelTurnEasing::EaseIn:		return FMath::InterpEaseIn(0.0f, 1.0f, rotationAlpha, turnEasingExponent);
+	case ETunnelTurnEasing::EaseOut:	return FMath::InterpEaseOut(0.0f, 1.0f, rotationAlpha, turnEasingExponent);
+	case ETunnelTurnEasing::EaseInOut:	return FMath::InterpEaseInOut(0.0f, 1.0f, rotationAlpha, turnEasingExponent);
+	default:				return rotationAlpha;
+	}
 }
 
-void ATunnelManager::removeBlockFromBuffer()
+void ATunnelManager::placeBlock(ABlock *block, const FVector &location, int32 rollSteps)
 {
-	tunnelBlocks.RemoveAt(0);
+	block->setBlockRoll(rollSteps);
+	if(keepPhysicsBodies)
+	{
+		if(block->GetRootComponent()->GetAttachParent() != tunnelArrow)
+		{
+			block->AttachToComponent(tunnelArrow, FAttachmentTransformRules::SnapToTargetNotIncludingScale);	// Attached once, recycled blocks are parked instead of detached
+			FOrionixTrace::traceBlock(EOrionixBlockEvent::Attached, block->GetUniqueID(), INDEX_NONE, block->meshIndex);
+			blockPool->invalidateCluster();						// The block now references the tunnel, clustered once all blocks are attached
+		}
+		block->unparkAndRestoreCollision(location);
+	}
+	else
+	{
+		block->AttachToComponent(tunnelArrow, FAttachmentTransformRules::SnapToTargetNotIncludingScale);
+		FOrionixTrace::traceBlock(EOrionixBlockEvent::Attached, block->GetUniqueID(), INDEX_NONE, block->meshIndex);
+		block->setBlockLocation(location);
+		block->unhideAndEnableCollision();
+	}
+	updateBlockInstance(block, true, location);
+	FOrionixTrace::traceBlock(EOrionixBlockEvent::Shown, block->GetUniqueID(), INDEX_NONE, block->meshIndex);
 }
 
-void ATunnelManager::updateRotation(float DeltaTime)
+void ATunnelManager::updateBlockInstance(ABlock *block, bool bVisible, const FVector &location)
 {
-	if((isRotatingLeft || isRotatingRight) && (rotationCount < rotationRepeatCount))
+	if(renderMode != ETunnelRenderMode::Instanced)
 	{
-		float rotationDirection = isRotatingRight ? rotationSpeed : -rotationSpeed;
-		rotateArrow(rotationDirection);
+		return;
+	}
+
+	UHierarchicalInstancedStaticMeshComponent *instances = getBlockInstances(block->meshIndex);
+	if(!instances)
+	{
+		return;
+	}
+
+	// A hidden block keeps its instance, so recycling it is only a transform update.
+	// Scaling an instance to nothing destroys its physics body, parking it keeps the body alive.
+	FTransform instanceTransform = FTransform(location);
+	if(!bVisible)
+	{
+		instanceTransform = keepPhysicsBodies ? FTransform(instanceParkingLocation) : FTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector);
+	}
+	if(block->instanceIndex == INDEX_NONE && freeInstanceSlots[block->meshIndex].Num() > 0)
+	{
+		block->instanceIndex = freeInstanceSlots[block->meshIndex].Pop(false);	// Reuses the instance of a block the pool destroyed
+	}
+	if(block->instanceIndex == INDEX_NONE)
+	{
+		block->instanceIndex = instances->AddInstance(instanceTransform);
 	}
 	else
 	{
-		resetRotation();
+		instances->UpdateInstanceTransform(block->instanceIndex, instanceTransform, false, true, true);
 	}
 }
 
-void ATunnelManager::rotateArrow(float rotationDirection)
+void ATunnelManager::handleBlockDestroying(ABlock *block)
 {
-	FRotator rotationAngle = FRotator(rotationDirection, 0.0f, 0.0f);
-	tunnelArrow->AddLocalRotation(rotationAngle);
-	rotationCount++;
+	if(block->instanceIndex == INDEX_NONE || !blockInstances.IsValidIndex(block->meshIndex) || !blockInstances[block->meshIndex])
+	{
+		return;
+	}
+
+	// The slot is kept instead of removed, removing an instance would move another block's instance into it.
+	// Scaling it to nothing destroys its physics body until a new block takes the slot.
+	blockInstances[block->meshIndex]->UpdateInstanceTransform(block->instanceIndex, FTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector), false, true, true);
+	freeInstanceSlots[block->meshIndex].Add(block->instanceIndex);
+	block->instanceIndex = INDEX_NONE;
 }
 
-void ATunnelManager::moveTriggerBoxesForward()
+UHierarchicalInstancedStaticMeshComponent *ATunnelManager::getBlockInstances(int32 meshIndex)
 {
-	FVector TBL_Location = triggerBoxLeft->GetRelativeLocation();
-	FVector TBR_Location = triggerBoxRight->GetRelativeLocation();
+	if(!blockInstances.IsValidIndex(meshIndex))
+	{
+		return nullptr;
+	}
 
-	TBL_Location += triggerBoxOffset;
-	TBR_Location += triggerBoxOffset;
-	triggerBoxLeft->SetRelativeLocation(TBL_Location);
-	triggerBoxRight->SetRelativeLocation(TBR_Location);
+	if(!blockInstances[meshIndex])
+	{
+		UStaticMesh *mesh = blockPool->getBlockMesh(meshIndex);
+		if(!mesh)
+		{
+			return nullptr;
+		}
+
+		LLM_SCOPE_BYTAG(Orionix_TunnelManager);
+		UHierarchicalInstancedStaticMeshComponent *instances = NewObject<UHierarchicalInstancedStaticMeshComponent>(this);
+		instances->SetStaticMesh(mesh);
+		instances->SetMobility(EComponentMobility::Movable);				// Moves with the tunnelArrow every frame
+		instances->SetupAttachment(tunnelArrow);					// Instance transforms are relative to the tunnelArrow, like attached blocks
+		instances->RegisterComponent();
+		blockInstances[meshIndex] = instances;
+	}
+	return blockInstances[meshIndex];
 }
 
-void ATunnelManager::resetRotation()
+void ATunnelManager::syncTriggerBoxes()
 {
-	isRotatingLeft = false;
-	isRotatingRight = false;
-	isRotationInProgress = false;
-	rotationCount = 0;
+	FVector triggerBoxShift = tunnelModel.getTriggerBoxShift();
+	triggerBoxLeft->SetRelativeLocation(triggerBoxLeftLocation + triggerBoxShift);
+	triggerBoxRight->SetRelativeLocation(triggerBoxRightLocation + triggerBoxShift);
 }
 
 void ATunnelManager::showTriggerBoxes()
@@ -250,14 +1116,13 @@ void ATunnelManager::showTriggerBoxes()
 
 void ATunnelManager::logBufferStatus() const
 {
-	UE_LOG(LogTemp, Warning, TEXT("Total Blocks: %d"), tunnelBlocks.Num());
+	const FTunnelSegmentBuffer &tunnelSegments = tunnelModel.getSegments();
+	UE_LOG(LogTemp, Warning, TEXT("Total Blocks: %d, Capacity: %d, First Segment: %lld"), tunnelSegments.num(), tunnelSegments.getCapacity(), tunnelSegments.getFirstSegmentNumber());
 }
 
 void ATunnelManager::logTunnelBlocksMemorySize() const
 {
-	int32 NumberOfElements = tunnelBlocks.Num();
-	int32 PointerSize = sizeof(ABlock *);
-	int32 ArrayMemoryUsage = NumberOfElements * PointerSize;
-	UE_LOG(LogTemp, Log, TEXT("TArray is using approximately %d bytes for its elements."), ArrayMemoryUsage);
+	const FTunnelSegmentBuffer &tunnelSegments = tunnelModel.getSegments();
+	UE_LOG(LogTemp, Log, TEXT("Tunnel segment buffer is using %llu bytes for %d segments."), (uint64)tunnelSegments.getAllocatedSize(), tunnelSegments.getCapacity());
 }
 
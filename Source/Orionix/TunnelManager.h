@@ -4,13 +4,48 @@
 #include "GameFramework/Actor.h"
 #include "Components/ArrowComponent.h"
 #include "Components/BoxComponent.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
 #include "FBlockPool.h"
+#include "FTunnelModel.h"
+#include "FTunnelSequenceGenerator.h"
+#include "FTunnelRandomStreams.h"
+#include "FTunnelReplay.h"
+#include "FFixedTimestep.h"
+#include "FTunnelSoakBenchmark.h"
+#include "FTunnelStreamingPrefetch.h"
 #include "Block.h"
 #include "TunnelManager.generated.h"
 
+/**
+ * @brief			How a tunnel turn progresses over its duration.
+ */
+UENUM()
+enum class ETunnelTurnEasing : uint8
+{
+	Linear,
+	EaseIn,
+	EaseOut,
+	EaseInOut
+};
 
+/**
+ * @brief			How the blocks of the tunnel are drawn. Selected with orionix.Tunnel.RenderMode when the tunnel starts.
+ */
+enum class ETunnelRenderMode : uint8
+{
+	Actors,										// Every block draws through its own UStaticMeshComponent
+	Instanced									// Every block is an instance of one UHierarchicalInstancedStaticMeshComponent per mesh type
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnBlockCatalogReady);				// Broadcast once every block of the catalog can be handed out by the pool
+
+/**
+ * @brief			View of the tunnel: owns the tunnelArrow, the pooled blocks and the trigger boxes and syncs them from an FTunnelModel.
+ *				The model holds the segment sequence, the tunnel frame and the block triggers; the view supplies blocks for
+ *				the segments the model appends and returns them to the pool when the model removes them.
+ */
 UCLASS()
-class ORIONIX_API ATunnelManager: public AActor
+class ORIONIX_API ATunnelManager: public AActor, public ITunnelModelListener
 {
 	GENERATED_BODY()
 
@@ -28,6 +63,13 @@ public:
 	 */
 	virtual ~ATunnelManager();
 
+	/**
+	 * @brief			Reports the blocks owned by the block pool to the garbage collector.
+	 * @param InThis		The tunnel manager.
+	 * @param Collector		Reference collector of the running garbage collection.
+	 */
+	static void AddReferencedObjects(UObject *InThis, FReferenceCollector &Collector);
+
 	/**
 	 * @brief			Called every frame.
 	 *				Use for update actor's position, check collision etc.
@@ -36,42 +78,129 @@ public:
 	virtual void Tick(float DeltaTime) override;
 
 	/**
-	 * @brief			Initializes the tunnel with blocks. Up to **maxBlocks** can be added to the tunnel.
+	 * @brief			Initializes the tunnel model and fills it with blocks. Up to **maxBlocks** can be added to the tunnel.
 	 *				Blocks are added to ArrowComponent because rotation operations are done through ArrowComponent.
+	 *				Only blocks whose mesh is already resident are used; the rest of the tunnel is filled by fillTunnel.
+	 *				The first block is the starter block, the others follow the sequence generator.
 	 */
 	void initializeTunnel();
 
 	/**
-	 * @brief			Subscribes to block trigger events for all blocks in the pool.
-	 *				Iterates through the block pool and binds the handleBlockTrigger function to the onBlockTriggered event of each block.
+	 * @brief			Tops the tunnel up to its target length with blocks that became available since the last frame.
+	 *				Needed while FBlockPool is still streaming block meshes.
 	 */
-	void subscribeToBlockEvents();
+	void fillTunnel();
 
 	/**
-	 * @brief			Takes a new block from pool, and adjust its collisions, visibility, etc. settings then adds to the tunnel.
-	 *				Each block is added to the ArrowComponent.
+	 * @brief			Takes a block for the next segment of the tunnel model: the starter block for an empty tunnel,
+	 *				else the block of the next generated segment.
+	 * @param bFirstSegment		Whether the tunnel is empty.
+	 * @param outDescriptor		Filled with the block type, roll and turn of the segment.
+	 * @param outLength		Filled with the baked length of the block.
+	 * @return			False if the pool has no block ready.
 	 */
-	void addBlockToTunnel();
+	virtual bool provideSegment(bool bFirstSegment, FTunnelSegmentDescriptor &outDescriptor, float &outLength) override;
 
 	/**
-	 * @brief			It removes the oldest block in the tunnel and returns it back into the pool.
+	 * @brief			Places the block taken by provideSegment at the location of the new segment.
+	 * @param segment		The new segment.
 	 */
-	void removeBlockFromTunnel();
+	virtual void onSegmentAdded(const FTunnelSegment &segment) override;
 
-	UFUNCTION()
 	/**
-	 * @brief			Handles a block trigger event by executing a sequence of actions:
-	 *				- Adds a new block to the end of the tunnel.
-	 *				- Removes the oldest block from the buffer to maintain tunnel length.
-	 *				- Moves trigger boxes forward to adjust for the new tunnel configuration.
+	 * @brief			Parks or hides the block of the removed segment and returns it back into the pool.
+	 * @param segment		The removed segment.
 	 */
-	void handleBlockTrigger();
+	virtual void onSegmentRemoved(const FTunnelSegment &segment) override;
+
+	/**
+	 * @brief			Hands the cost of a block trigger to the soak benchmark.
+	 * @param seconds		Time the trigger took.
+	 */
+	virtual void onBlockTriggerHandled(double seconds) override;
+
+	/**
+	 * @brief			Called by the block pool once the full block catalog has been spawned and streamed in.
+	 *				Forwards the event to onBlockCatalogReady.
+	 */
+	void handleCatalogReady();
 
 	void turnRight();
 	void turnLeft();
 	void triggerRandomTurn();
+
+	/**
+	 * @brief			Turns the tunnel for a player input and records the input when a replay is being recorded,
+	 *				stamped with the index of the next simulation step, the first one that sees the turn.
+	 *				An input made during a turn is queued by the tunnel model and chained to it. The input is stamped
+	 *				with the current time for the input to rotated frame latency. Live inputs are ignored while a replay is played back.
+	 * @param turn			Turn the player asked for.
+	 */
+	void handleTurnInput(ETunnelTurn turn);
 	void onTurnTimerExpired();
 
+	/**
+	 * @brief			Logs how many tunnel primitives are left visible with the active render mode, before the engine culls them.
+	 *				Used by orionix.Tunnel.RenderStats to compare both render modes without a renderer.
+	 */
+	void logRenderStats() const;
+
+	/**
+	 * @brief			Returns the number of tunnel primitives updateVisibleSet left visible: one per block actor with a visible mesh,
+	 *				or one per instanced component with at least one block before its cull distance. Read from the flags the
+	 *				tunnel sets, not from the renderer, so frustum and occlusion culling are not counted; see stat SceneRendering.
+	 * @return			Number of primitives left visible
+	 */
+	int32 countVisiblePrimitives() const;
+
+	/**
+	 * @brief			Logs the simulated steps and time and the simulation throughput in steps per wall clock second.
+	 *				Used by orionix.Sim.Stats and at the end of a headless run to compare builds.
+	 */
+	void logSimulationStats() const;
+
+	/**
+	 * @brief			Logs the status and runtime counters of the block pool.
+	 */
+	void logPoolStats() const;
+
+	/**
+	 * @brief			Logs the memory of the block pool and its meshes and the size of the segment buffer.
+	 *				Used by orionix.Memory.Dump after the LLM tags.
+	 */
+	void logMemoryStats() const;
+
+	/**
+	 * @brief			Times full garbage collections with the pooled blocks clustered and with the cluster dissolved, and logs both.
+	 *				Used by orionix.GC.Measure.
+	 * @param collections		Number of collections timed in each configuration.
+	 * @param extraBlocks		Free blocks spawned first, so a large pool can be measured.
+	 */
+	void measureGarbageCollection(int32 collections, int32 extraBlocks);
+
+	/**
+	 * @brief			Logs the number of block recycles and their average and worst cost with the active recycle mode.
+	 */
+	void logRecycleStats() const;
+
+	/**
+	 * @brief			Logs the average and worst latency from a turn input to the first frame showing the turn,
+	 *				and the queued and dropped turns. Used by orionix.Tunnel.TurnStats.
+	 */
+	void logTurnStats() const;
+
+	/**
+	 * @brief			Logs the runner's speed through the tunnel against the target and live segment counts and the time the
+	 *				segments ahead cover. Used by orionix.Tunnel.LookaheadStats.
+	 */
+	void logLookaheadStats() const;
+
+	/**
+	 * @brief			Logs the streaming hints issued and how many segments became visible with non-resident LODs or mips.
+	 *				Used by orionix.Streaming.Stats.
+	 */
+	void logStreamingStats() const;
+
 protected:
 	/**
 	 * @brief			Called when the game starts or when spawned.
@@ -79,6 +208,12 @@ protected:
 	 */
 	virtual void BeginPlay() override;
 
+	/**
+	 * @brief			Called when the tunnel is removed from the world. Waits for the sequence generator's worker.
+	 * @param EndPlayReason		Why the tunnel is removed.
+	 */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	UFUNCTION()
 	/**
 	 * @brief				Called when the character component starts overlapping the trigger box on the left side of the tunnel.
@@ -110,47 +245,171 @@ private:
 	void generateTriggerBoxPairs();
 
 	/**
-	 * @brief			Adds a new block to the tunnel block buffer.
-	 *				This function appends the provided block to the end of the tunnelBlocks TArray.
+	 * @brief			Takes the block of the next segment descriptor from the pool and consumes the descriptor.
+	 *				Picks a random block on the game thread when the sequence generator has fallen behind.
+	 * @param outDescriptor		Filled with the descriptor of the segment.
+	 * @return			The block, or nullptr if the pool has no block of the generated type ready; the descriptor is then left
+	 *				for the next call, so the tunnel waits for the pool's growth instead of leaving the generated sequence.
+	 */
+	ABlock *acquireNextBlock(FTunnelSegmentDescriptor &outDescriptor);
+
+	/**
+	 * @brief			Picks the seed of the run and seeds every random stream from it.
+	 *				The seed comes from the replay given with -OrionixReplay=<file>, else from orionix.Tunnel.Seed, else from the clock.
+	 *				-OrionixRecordReplay=<file> records the run into a replay saved in EndPlay.
+	 */
+	void initializeRandomStreams();
+
+	/**
+	 * @brief			Applies the replay inputs due before the simulation step in progress and verifies the block sequence once the playback is complete.
+	 *				Exits the game after the verification when -OrionixReplayExit is given, for headless runs.
+	 */
+	void playReplayInputs();
+
+	/**
+	 * @brief			Returns the block drawing a segment of the tunnel model
+	 * @param segment		A segment in the tunnel
+	 * @return			The block, or nullptr
 	 */
+	ABlock *getSegmentBlock(const FTunnelSegment &segment) const;
 
-	 /**
-	  * @brief			Adds a new block to the tunnel block buffer.
-	  *				This function appends the provided block to the end of the tunnelBlocks TArray.
-	  * @param newBlock		The block to be added to the tunnel.
-	  */
-	void addBlockToBuffer(ABlock *newBlock);
+	/**
+	 * @brief			Returns the component the runner collides with on a segment: the mesh of its block, or the instanced
+	 *				component of its mesh type in instanced mode.
+	 * @param segment		A segment in the tunnel
+	 * @return			The component, or nullptr
+	 */
+	UPrimitiveComponent *getSegmentComponent(const FTunnelSegment &segment) const;
 
 	/**
-	 * @brief			Removes the oldest block from the tunnel block buffer.
+	 * @brief			Returns whether the side of a segment's block facing down is a solid floor, see FBlockPool::hasSolidFloor.
+	 * @param segment		A segment in the tunnel
+	 * @return			False for a floor with gaps and while the block or its mesh is missing
 	 */
-	void removeBlockFromBuffer();
+	bool hasSolidFloor(const FTunnelSegment &segment) const;
 
 	/**
-	 * @brief			Updates the rotation of the ArrowComponent based on current rotation flags and limits.
-	 *				If rotation is initiated (left or right) and has not reached the repeat count,
-	 *				it applies a rotation each frame. Once the rotation limit is reached, it resets the rotation state.
-	 * @param DeltaTime		The time elapsed since the last frame, used for frame-independent movement.
+	 * @brief			Applies **turnEasing** to the progress of a turn. Used as the easing of the tunnel model.
+	 * @param rotationAlpha		Linear progress of the turn, 0 to 1.
+	 * @return			Eased progress of the turn.
 	 */
-	void updateRotation(float DeltaTime);
+	float easeTurn(float rotationAlpha) const;
 
 	/**
-	 * @brief			Applies a rotation to the tunnelArrow based on the specified direction.
-	 * @param rotationDirection	The direction and magnitude of the rotation to apply.
+	 * @brief			Attaches a block to the tunnelArrow at the given location and makes it part of the visible tunnel.
+	 *				When **keepPhysicsBodies** is set a recycled block is unparked instead of attached and having its collision enabled again.
+	 * @param block			The block taken from the pool.
+	 * @param location		Location of the block relative to the tunnelArrow.
+	 * @param rollSteps		Roll of the block in quarter turns.
 	 */
-	void rotateArrow(float rotationDirection);
+	void placeBlock(ABlock *block, const FVector &location, int32 rollSteps);
 
 	/**
-	 * @brief			Moves both left and right trigger boxes forward based on the predefined offset.
-	 *				The new location is calculated by adding the **triggerBoxOffset** to their current positions.
+	 * @brief			Moves the instance drawing the block to the block's place in the tunnel, or hides it.
+	 *				Does nothing unless the tunnel renders instanced.
+	 * @param block			The block whose instance is updated.
+	 * @param bVisible		Whether the block is part of the tunnel.
+	 * @param location		Location of the block relative to the tunnelArrow, used when it is visible.
 	 */
-	void moveTriggerBoxesForward();
+	void updateBlockInstance(ABlock *block, bool bVisible, const FVector &location = FVector::ZeroVector);
 
 	/**
-	 * @brief			Resets the rotation state of the **tunnelArrow**.
-	 *				It should be called once the desired rotation is completed or needs to be aborted.
+	 * @brief			Called by the block pool before it destroys a block. Hides the block's instance and keeps its slot
+	 *				for the next block of the mesh type, so shrinking the pool does not leak parked instances.
+	 * @param block			The block about to be destroyed.
 	 */
-	void resetRotation();
+	void handleBlockDestroying(ABlock *block);
+
+	/**
+	 * @brief			Returns the instanced component drawing a mesh type, creating it the first time the mesh type is used.
+	 * @param meshIndex		Mesh type of the block in FBlockPool.
+	 * @return			The instanced component, or nullptr if the mesh is not resident yet.
+	 */
+	UHierarchicalInstancedStaticMeshComponent *getBlockInstances(int32 meshIndex);
+
+	/**
+	 * @brief			Runs one fixed simulation step: replay inputs and the runner speed ramp, then scrolling, block triggers and rotation in the tunnel model.
+	 *				The simulation works on the tunnel model, never on the rendered arrow.
+	 * @param StepSeconds		The length of the simulation step.
+	 */
+	void stepSimulation(float StepSeconds);
+
+	/**
+	 * @brief			Tells the runner movement whether the tunnel floor is at rest, which block the runner stands on and whether
+	 *				the floor of that block and the next one is solid, so it can resolve the floor analytically. Does nothing for a runner without URunnerMovementComponent.
+	 */
+	void updateRunnerFloor();
+
+	/**
+	 * @brief			Measures the latency of a player turn once the frame showing its first rotated step has been applied.
+	 *				Published as the Turn Input Latency stat and CSV stat.
+	 */
+	void recordTurnLatency();
+
+	/**
+	 * @brief			Draws the first orionix.Tunnel.VisibleBlocks segments from the runner's block and hides the rest of the tunnel.
+	 *				A draw distance rather than a cull: nothing hides the far end of the tube yet, so the hidden segments would be
+	 *				seen and pop in, which is why it is off by default. Hidden blocks keep their collision. Block actors hide their
+	 *				mesh, instanced components get a cull distance at the end of the visible segments. Hidden blocks are not
+	 *				occlusion-queried. With no count every segment is drawn and left to the engine's culling.
+	 */
+	void updateVisibleSet();
+
+	/**
+	 * @brief			Sets the target length of the tunnel from the runner's speed through it, so the segments ahead of the runner
+	 *				cover orionix.Tunnel.LookaheadSeconds. Between orionix.Tunnel.MinBlocks and **maxBlocks** segments.
+	 * @param DeltaTime		Time elapsed since the last frame, smooths the measured speed.
+	 */
+	void updateLookahead(float DeltaTime);
+
+	/**
+	 * @brief			Keeps the first orionix.Tunnel.NearBlocks segments at full fidelity and the rest of the tunnel at far detail,
+	 *				see ABlock::setFarDetail. Only block actors have detail levels, instanced components LOD on their own.
+	 */
+	void updateDetailLevels();
+
+	/**
+	 * @brief			Forces the mesh LODs and texture mips of every segment the runner reaches within orionix.Streaming.PrefetchSeconds
+	 *				resident, once per segment, for its time to arrival plus a margin. Segments past the visible set are hinted
+	 *				before updateVisibleSet shows them.
+	 */
+	void updateStreamingPrefetch();
+
+	/**
+	 * @brief			Returns whether the segment at an index of the tunnel is outside the near window
+	 * @param segmentIndex		Index of the segment, 0 is the runner's block.
+	 * @return			True if the segment is drawn and collides at far detail
+	 */
+	bool isFarSegment(int32 segmentIndex) const;
+
+	/**
+	 * @brief			Moves the tunnelArrow between the previous and the current simulation state, so rendering stays smooth
+	 *				whatever the ratio between the frame rate and the step rate.
+	 * @param interpolationAlpha	How far the clock is between the last step and the next one.
+	 */
+	void applySimulationState(float interpolationAlpha);
+
+	/**
+	 * @brief			Publishes the live and pooled block counts, the recycle rate and the time spent turning
+	 *				to stat Orionix and to the Orionix CSV profiler category.
+	 * @param DeltaTime		The time elapsed since the last frame.
+	 */
+	void updateStats(float DeltaTime);
+
+	/**
+	 * @brief			Sets up the simulation clock from orionix.Sim.StepRate.
+	 *				-OrionixHeadless makes the engine advance a fixed time per frame without waiting for real time, so with -nullrhi
+	 *				the simulation runs as fast as the CPU allows. -OrionixStepsPerFrame=<n> runs n steps per engine frame and
+	 *				-OrionixSimSeconds=<seconds> logs the throughput and exits once that much time has been simulated.
+	 *				-OrionixSoak=<recycles> runs headless too and exits once the soak benchmark has written its report.
+	 */
+	void initializeSimulation();
+
+	/**
+	 * @brief			Moves both left and right trigger boxes to their initial location plus the shift of the tunnel model.
+	 *				The model moves them forward by **triggerBoxOffset** on every block trigger.
+	 */
+	void syncTriggerBoxes();
 
 	/**
 	 * @brief			Makes the left and right trigger boxes visible in-game and sets their colors.
@@ -163,7 +422,7 @@ private:
 	void logBufferStatus() const;
 
 	/**
-	 * @brief			Logs the memory size used by the tunnelBlocks TArray in bytes.
+	 * @brief			Logs the memory size used by the segment buffer of the tunnel model in bytes.
 	 */
 	void logTunnelBlocksMemorySize() const;
 
@@ -171,6 +430,9 @@ private:
 	 * **VARIABLE DECLARATIONS**
 	 */
 public:
+	UPROPERTY(BlueprintAssignable)								// Can be bound to in Blueprints
+	FOnBlockCatalogReady onBlockCatalogReady;						// Every block type is available, until then the tunnel is built from the blocks spawned so far
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Trigger")			// Always visible, cannot be changed, readable but not writeable in Blueprints, listed in the Trigger category
 	UBoxComponent *triggerBoxLeft;								// Represents the left side of the tunnel
 
@@ -182,19 +444,60 @@ private:
 	UArrowComponent *tunnelArrow;								// It represents the direction and skeleton of the tunnel
 
 	FBlockPool *blockPool;									// Block pool
-	TArray<ABlock *> tunnelBlocks;								// Blocks in the tunnel
+	FTunnelModel tunnelModel;								// Segments, tunnel frame, block triggers and turns of the tunnel
+	UPROPERTY()
+	TArray<ABlock *> segmentBlocks;								// Block of every segment in the tunnel, in slot segmentNumber % capacity like the segment buffer
+	UPROPERTY()
+	ABlock *pendingBlock = nullptr;								// Block taken by provideSegment, placed by onSegmentAdded
+	TWeakObjectPtr<APawn> runner;								// Pawn whose progress triggers the blocks
+	ETunnelRenderMode renderMode = ETunnelRenderMode::Actors;				// How the blocks are drawn
+	bool keepPhysicsBodies = true;								// Recycled blocks are parked instead of having their collision disabled
+	FVector blockParkingLocation = FVector(0, 0, -100000);					// World location where parked blocks wait
+	FVector instanceParkingLocation;							// Location relative to the tunnelArrow where parked instances wait
+
+	UPROPERTY()
+	TArray<UHierarchicalInstancedStaticMeshComponent *> blockInstances;			// Instanced component of every mesh type, indexed by ABlock::meshIndex
+	TArray<TArray<int32>> freeInstanceSlots;						// Instances of destroyed blocks, hidden and reused by the next block of the mesh type
+	FTunnelSequenceGenerator sequenceGenerator;						// Picks the upcoming segments on a worker thread
+	FTunnelRandomStreams randomStreams;							// Seeded random stream of every subsystem
+	FTunnelReplay replay;									// Records or plays back the seed and turn inputs of the run
+	FString replayRecordPath;								// File the recorded replay is saved to
+	bool replayVerified = false;								// Whether the playback has been verified
+
+	FFixedTimestep simulationClock;								// Fixed simulation steps of the tunnel
+	double simulationWallStartTime = 0.0;							// Wall clock time the simulation started
+	double headlessSimulationSeconds = 0.0;							// Simulated time after which a headless run exits, 0 runs forever
+	FTunnelSoakBenchmark soakBenchmark;							// Frame, recycle and memory samples of a soak run
+	int64 statRecycleCount = 0;								// Recycle count at the start of the current rate window
+	double statRecycleWindowSeconds = 0.0;							// Time elapsed in the current rate window
+	uint32 statRecyclesPerSecond = 0;							// Recycle rate of the last complete window
+	int64 turnLatencyCount = 0;								// Player turns whose latency was measured
+	double totalTurnLatency = 0.0;								// Sum of the measured turn latencies, in seconds
+	double maxTurnLatency = 0.0;								// Worst turn latency, in seconds
+	int32 visibleBlockCount = 0;								// Segments drawn after the last updateVisibleSet
+	float runnerSpeed = 0.0f;								// Smoothed speed of the runner along the tunnel, tunnel scrolling included
+	FTunnelStreamingPrefetch streamingPrefetch;						// Streaming hints and pop-in count of the upcoming segments
+	int64 lastPrefetchedSegment = INDEX_NONE;						// Newest segment number hinted by updateStreamingPrefetch
+	int64 lastShownSegment = INDEX_NONE;							// Newest segment number that became visible
 	int32 maxBlocks = 10;									// Maximum number of blocks that can be in the tunnel at the same time
 
+	UPROPERTY(VisibleAnywhere, Category = "Platform Velocity")
+	FVector platformVelocity = FVector(500, 0, 0);						// World space velocity the tunnel scrolls with
+
 	FVector startPosition = FVector(-250, 0, -250);						// Position of the first block. It represents starting position of the tunnel.
-	FVector blockOffset = FVector(0, 800, 0);						// Lenght of block
+	FVector blockOffset = FVector(0, 800, 0);						// Direction of the tunnel relative to the tunnelArrow, each block is placed its own length further
 	FVector triggerBoxOffset = FVector(-800, 0, 0);						// Lenght of block 
+	FVector triggerBoxLeftLocation = FVector(-1600, 250, 500);				// Initial location of the left trigger box
+	FVector triggerBoxRightLocation = FVector(-1600, -250, 500);				// Initial location of the right trigger box
+
+	UPROPERTY(EditAnywhere, Category = "Rotation", meta = (ClampMin = "0"))
+	float turnDuration = 0.75f;								// Seconds a quarter turn takes
+
+	UPROPERTY(EditAnywhere, Category = "Rotation")
+	ETunnelTurnEasing turnEasing = ETunnelTurnEasing::Linear;				// How a turn progresses over its duration
 
-	float rotationSpeed = 2.0f;								// Desired rotation speed. It must be divisible bt ninety	--> 1.2
-	int32 rotationRepeatCount = 90.0f / rotationSpeed;					// Amount of rotation required
-	int32 rotationCount = 0;								// Count of current rotation
-	bool isRotatingLeft = false;								// Controls left turn
-	bool isRotatingRight = false;								// Controls right turn
-	bool isRotationInProgress = false;							// Controls active rotation
+	UPROPERTY(EditAnywhere, Category = "Rotation", meta = (ClampMin = "1"))
+	float turnEasingExponent = 2.0f;							// Strength of the ease in and ease out curves
 
 	FTimerHandle TurnTimerHandle;
 };